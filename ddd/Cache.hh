@@ -2,6 +2,7 @@
 #define _CACHE_HH_
   
 #include "ddd/util/configuration.hh"
+#include "ddd/CacheBudget.hh"
 
 template
     <
@@ -10,18 +11,34 @@ template
     , typename ResType
     , typename EvalFunc=int
   >
-class Cache
+class Cache : public BudgetedCache
 {
 private:
   mutable size_t peak_;
+  /// entries kept and dropped by sweep
+  size_t kept_;
+  size_t dropped_;
   
-  typedef typename  hash_map< std::pair<FuncType, ParamType>, ResType >::type 
+  typedef typename  hash_map< std::pair<FuncType, ParamType>, Stamped<ResType> >::type 
                     hash_map; 
   hash_map cache_;
+
+  /// estimated memory of an entry, see CacheBudget
+  static size_t entry_size () {
+    return sizeof(std::pair<const std::pair<FuncType, ParamType>, Stamped<ResType> >) + 2 * sizeof(void *);
+  }
+
+  /// an entry is dead if its function, its parameter or its result is not marked
+  struct dead_entry {
+    bool operator() (const std::pair<const std::pair<FuncType, ParamType>, Stamped<ResType> > & e) const {
+      return ! (e.first.first.is_marked() && e.first.second.is_marked() && e.second.value.is_marked());
+    }
+  };
     
 public:
-  Cache () : peak_ (0) {};
-  Cache (size_t s) : peak_ (0), cache_ (s) {};
+  /// \param name the name of the cache in statistics, and for MemoryManager::setCachePolicy
+  Cache (const char * name = "Cache") : BudgetedCache (name, entry_size ()), peak_ (0), kept_ (0), dropped_ (0) {};
+  Cache (size_t s, const char * name = "Cache") : BudgetedCache (name, entry_size ()), peak_ (0), kept_ (0), dropped_ (0), cache_ (s) {};
     
   /** clear the cache, discarding all values. */
   void clear (bool keepstats = false) {
@@ -29,6 +46,32 @@ public:
     cache_.clear();
   }
 
+  /** garbage collection : discard the entries that refer to an object that is not marked,
+   *  keep the others. Called between the mark and sweep phases of MemoryManager::garbage().
+   *  Operations are never applied to a null parameter through the cache, so the default key
+   *  is free to mark erased entries. */
+  void sweep () {
+    peak();
+    size_t dropped = cache_.erase_if(dead_entry());
+    dropped_ += dropped;
+    kept_ += size();
+  }
+
+  /// number of entries kept by sweep, since the last reset_sweep_stats
+  size_t kept () const {
+    return kept_;
+  }
+
+  /// number of entries dropped by sweep, since the last reset_sweep_stats
+  size_t dropped () const {
+    return dropped_;
+  }
+
+  void reset_sweep_stats () {
+    kept_ = 0;
+    dropped_ = 0;
+  }
+
   size_t peak () const {
     size_t s = size();
     if ( peak_ < s )
@@ -41,6 +84,12 @@ public:
     return cache_.size();
   }
 
+  /** cache budget : evict entries following the policy of the cache, until at most target remain. */
+  size_t evict (size_t target) {
+    peak();
+    return CacheBudget::evict(cache_, policy(), target, CacheBudget::no_release());
+  }
+
   ResType eval (const  FuncType & func, const ParamType  & param) const {
     return func.eval(param);
   }
@@ -59,27 +108,53 @@ public:
       { // lock on current bucket
 	typename hash_map::const_accessor access;
 	found = cache_.find ( access, std::make_pair(hom,node));
-	if (found)
-	  return std::make_pair(false, access->second);
+	if (found) {
+#ifndef REENTRANT
+	  access->second.stamp = CacheBudget::tick();
+#endif
+	  return std::make_pair(false, access->second.value);
+	}
       } // end of lock on the current bucket
       
       // wasn't in cache
       ResType result = eval(hom, node);
       if (should_insert (hom))
       {
-      // lock on current bucket
+      bool insertion;
+      { // lock on current bucket
       typename hash_map::accessor access;
-      bool insertion = cache_.insert ( access, std::make_pair(hom,node));
+      insertion = cache_.insert ( access, std::make_pair(hom,node));
       if (insertion) {
 	// should happen except in MT case
-	access->second = result;
+	access->second.value = result;
+	access->second.stamp = CacheBudget::tick();
+      }
+      } // end of lock on the current bucket
+      if (insertion) {
+	// may evict entries, once the bucket is released
+	CacheBudget::inserted(entry_bytes());
       }
       return std::make_pair(insertion,result);
       }
       else
         return std::make_pair (false, result);
     }
-  
+
+    /// lookup only : (true, result) if hom(node) is in the cache, (false, _) otherwise.
+    /// Lets callers collect the hits before solving the misses, possibly in parallel.
+    std::pair<bool,ResType>
+    contains(const FuncType& hom, const ParamType& node) const
+    {
+      typename hash_map::const_accessor access;
+      if (cache_.find ( access, std::make_pair(hom,node))) {
+#ifndef REENTRANT
+	access->second.stamp = CacheBudget::tick();
+#endif
+	return std::make_pair(true, access->second.value);
+      }
+      return std::make_pair(false, ResType());
+    }
+
 #ifdef HASH_STAT
   std::map<std::string, size_t> get_hits() const { return cache_.get_hits(); }
   std::map<std::string, size_t> get_misses() const { return cache_.get_misses(); }
@@ -0,0 +1,157 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+#include <iostream>
+
+#include "ddd/CacheBudget.hh"
+
+/******************************************************************************/
+/*                           class BudgetedCache                              */
+/******************************************************************************/
+
+BudgetedCache::BudgetedCache (const char * name, size_t entry_bytes)
+  : name_ (name), entry_bytes_ (entry_bytes), policy_ (CACHE_CLOCK), evicted_ (0)
+{
+  CacheBudget::caches().push_back (this);
+}
+
+BudgetedCache::~BudgetedCache ()
+{
+  std::vector<BudgetedCache *> & caches = CacheBudget::caches();
+  caches.erase (std::remove (caches.begin(), caches.end(), this), caches.end());
+}
+
+void BudgetedCache::shrink (size_t target_bytes)
+{
+  evicted_ += evict (target_bytes / entry_bytes_);
+}
+
+/******************************************************************************/
+/*                           class CacheBudget                                */
+/******************************************************************************/
+
+size_t CacheBudget::budget_ = 0;
+#ifdef REENTRANT
+std::atomic<size_t> CacheBudget::estimate_ (0);
+std::atomic<cache_stamp_t> CacheBudget::tick_ (0);
+#else
+size_t CacheBudget::estimate_ = 0;
+cache_stamp_t CacheBudget::tick_ = 0;
+#endif
+size_t CacheBudget::reclaims_ = 0;
+
+// caches are static objects of several compilation units, that register at construction time :
+// the registry is built on first use and never destroyed.
+std::vector<BudgetedCache *> & CacheBudget::caches ()
+{
+  static std::vector<BudgetedCache *> * caches = new std::vector<BudgetedCache *> ();
+  return *caches;
+}
+
+void CacheBudget::setBudget (size_t bytes)
+{
+  budget_ = bytes;
+  estimate_ = used();
+#ifndef REENTRANT
+  reclaim();
+#endif
+}
+
+size_t CacheBudget::used ()
+{
+  size_t total = 0;
+  const std::vector<BudgetedCache *> & all = caches();
+  for (std::vector<BudgetedCache *>::const_iterator it = all.begin(); it != all.end(); ++it) {
+    total += (*it)->bytes();
+  }
+  return total;
+}
+
+void CacheBudget::setPolicy (CachePolicy p)
+{
+  const std::vector<BudgetedCache *> & all = caches();
+  for (std::vector<BudgetedCache *>::const_iterator it = all.begin(); it != all.end(); ++it) {
+    (*it)->set_policy (p);
+  }
+}
+
+bool CacheBudget::setPolicy (const std::string & name, CachePolicy p)
+{
+  bool found = false;
+  const std::vector<BudgetedCache *> & all = caches();
+  for (std::vector<BudgetedCache *>::const_iterator it = all.begin(); it != all.end(); ++it) {
+    if (name == (*it)->name()) {
+      (*it)->set_policy (p);
+      found = true;
+    }
+  }
+  return found;
+}
+
+void CacheBudget::reclaim ()
+{
+  if (budget_ == 0)
+    return;
+  size_t total = used();
+  if (total > budget_) {
+    // every cache keeps its share of three quarters of the budget
+    double ratio = double (budget_ - budget_ / 4) / double (total);
+    const std::vector<BudgetedCache *> & all = caches();
+    for (std::vector<BudgetedCache *>::const_iterator it = all.begin(); it != all.end(); ++it) {
+      (*it)->shrink ((size_t) ((*it)->bytes() * ratio));
+    }
+    ++reclaims_;
+    total = used();
+  }
+  estimate_ = total;
+}
+
+static const char * policy_name (CachePolicy p)
+{
+  switch (p) {
+  case CACHE_LRU :
+    return "LRU";
+  case CACHE_RANDOM :
+    return "random";
+  default :
+    return "clock";
+  }
+}
+
+void CacheBudget::pstats (bool reinit)
+{
+  std::cout << "*\nCache budget : " << used() << " bytes used";
+  if (budget_ != 0)
+    std::cout << " out of " << budget_ << ", caches shrunk " << reclaims_ << " times";
+  else
+    std::cout << ", unbounded";
+  std::cout << std::endl;
+  const std::vector<BudgetedCache *> & all = caches();
+  for (std::vector<BudgetedCache *>::const_iterator it = all.begin(); it != all.end(); ++it) {
+    std::cout << (*it)->name() << " : " << (*it)->size() << " entries, " << (*it)->bytes() << " bytes, "
+              << policy_name ((*it)->policy()) << " policy, " << (*it)->evicted() << " entries evicted" << std::endl;
+    if (reinit)
+      (*it)->reset_evicted();
+  }
+  if (reinit)
+    reclaims_ = 0;
+}
@@ -0,0 +1,238 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/* -*- C++ -*- */
+#ifndef _CACHE_BUDGET_HH_
+#define _CACHE_BUDGET_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifdef REENTRANT
+#include <atomic>
+#endif
+
+/// Eviction policies of the caches bounded by the cache budget, see MemoryManager::setCacheBudget.
+enum CachePolicy {
+  /// second chance : entries used since the previous eviction pass survive the next one
+  CACHE_CLOCK,
+  /// the least recently used entries are evicted first
+  CACHE_LRU,
+  /// entries are evicted at random
+  CACHE_RANDOM
+};
+
+/// Stamps of cache entries, on 32 bits so that the stamp fits in the padding after a node id.
+/// When the counter wraps around the LRU order is only approximate for a while.
+typedef unsigned int cache_stamp_t;
+
+/// A cached value and the stamp of its last use, used by the eviction policies.
+/// A null stamp means that the entry was not used since the last clock pass.
+template <typename T>
+struct Stamped {
+  T value;
+  mutable cache_stamp_t stamp;
+
+  Stamped () : value (), stamp (0) {}
+};
+
+/// Base class of the caches whose memory is bounded by the cache budget.
+/// A cache registers itself at construction, reports its memory and evicts entries on demand.
+class BudgetedCache {
+  const char * name_;
+  /// estimated memory of an entry, in bytes
+  size_t entry_bytes_;
+  CachePolicy policy_;
+  /// entries evicted since the last pstats
+  size_t evicted_;
+
+  BudgetedCache (const BudgetedCache &);
+  BudgetedCache & operator= (const BudgetedCache &);
+public:
+  BudgetedCache (const char * name, size_t entry_bytes);
+  virtual ~BudgetedCache ();
+
+  /// number of entries
+  virtual size_t size () const = 0;
+  /// Evict entries, following the policy, until at most target entries remain.
+  /// Returns the number of entries evicted. Not thread safe.
+  virtual size_t evict (size_t target) = 0;
+  /// estimated memory used, in bytes
+  virtual size_t bytes () const { return size () * entry_bytes_; }
+
+  const char * name () const { return name_; }
+  size_t entry_bytes () const { return entry_bytes_; }
+  CachePolicy policy () const { return policy_; }
+  void set_policy (CachePolicy p) { policy_ = p; }
+  size_t evicted () const { return evicted_; }
+
+  /// evict entries until the cache uses at most target_bytes, updates the evicted count
+  void shrink (size_t target_bytes);
+  void reset_evicted () { evicted_ = 0; }
+};
+
+/// The cache budget : a bound on the memory used by all registered caches together.
+/// Note that all functions are static, use the MemoryManager interface.
+///
+/// Caches call inserted() when they add an entry. This only updates an estimate of the memory
+/// used; when it exceeds the budget, the exact usage is computed and, if it is really exceeded,
+/// every cache evicts entries with its own policy, proportionally to its share of the memory,
+/// until three quarters of the budget is used.
+/// In REENTRANT builds other threads may be using the caches, so eviction is deferred until the
+/// next MemoryManager::garbage(), and MemoryManager::should_garbage() reports the overflow.
+class CacheBudget {
+  /// in bytes, 0 when caches are unbounded
+  static size_t budget_;
+#ifdef REENTRANT
+  static std::atomic<size_t> estimate_;
+  static std::atomic<cache_stamp_t> tick_;
+#else
+  static size_t estimate_;
+  static cache_stamp_t tick_;
+#endif
+  /// number of times caches were shrunk
+  static size_t reclaims_;
+
+  static std::vector<BudgetedCache *> & caches ();
+  friend class BudgetedCache;
+
+  /// state of an eviction pass, shared by the copies of evict_if
+  struct eviction {
+    CachePolicy policy;
+    /// entries to evict and entries not visited yet
+    size_t need;
+    size_t left;
+    /// LRU : entries stamped up to threshold are evicted
+    cache_stamp_t threshold;
+    /// RANDOM : xorshift state
+    size_t seed;
+  };
+
+  /// the predicate given to erase_if, release is called on evicted entries
+  template <typename Release>
+  struct evict_if {
+    eviction * ev;
+    Release release;
+
+    template <typename Entry>
+    bool operator() (const Entry & e) const {
+      if (ev->need == 0)
+        return false;
+      bool out;
+      switch (ev->policy) {
+      case CACHE_LRU :
+        out = e.second.stamp <= ev->threshold;
+        break;
+      case CACHE_RANDOM :
+        // selection sampling : evicts exactly need entries of the left ones
+        ev->seed ^= ev->seed << 13;
+        ev->seed ^= ev->seed >> 7;
+        ev->seed ^= ev->seed << 17;
+        out = ev->seed % ev->left < ev->need;
+        break;
+      default :
+        // CLOCK : give used entries a second chance
+        out = e.second.stamp == 0;
+        e.second.stamp = 0;
+        break;
+      }
+      --ev->left;
+      if (out) {
+        --ev->need;
+        release (e);
+      }
+      return out;
+    }
+  };
+
+public:
+  /// Nothing to release when an entry is evicted.
+  struct no_release {
+    template <typename Entry>
+    void operator() (const Entry &) const {}
+  };
+
+  /// Set the budget in bytes, 0 (the default) means unbounded caches.
+  static void setBudget (size_t bytes);
+  static size_t budget () { return budget_; }
+  /// exact memory used by the registered caches, in bytes
+  static size_t used ();
+  /// whether the budget is exceeded, and caches should be shrunk
+  static bool exceeded () { return budget_ != 0 && used () > budget_; }
+
+  /// Set the eviction policy of all caches.
+  static void setPolicy (CachePolicy p);
+  /// Set the eviction policy of the caches of a given name, returns false if there is none.
+  static bool setPolicy (const std::string & name, CachePolicy p);
+
+  /// To call when an entry of the given size is added to a cache.
+  static void inserted (size_t bytes) {
+    if (budget_ != 0 && (estimate_ += bytes) > budget_) {
+#ifndef REENTRANT
+      reclaim ();
+#endif
+    }
+  }
+
+  /// A new stamp for a used entry.
+  static cache_stamp_t tick () {
+    return ++tick_;
+  }
+
+  /// Shrink the caches if the budget is exceeded. Not thread safe.
+  static void reclaim ();
+
+  /// Prints the memory used by each cache, also reinitializes eviction counts.
+  static void pstats (bool reinit = true);
+
+  /// Evict entries of map following policy, until at most target remain.
+  /// Mapped values of map are Stamped. Returns the number of entries evicted.
+  template <typename Map, typename Release>
+  static size_t evict (Map & map, CachePolicy policy, size_t target, const Release & release) {
+    size_t size = map.size ();
+    if (size <= target)
+      return 0;
+    eviction ev = { policy, size - target, size, 0, 0x2545F491 + size };
+    if (policy == CACHE_LRU) {
+      // the stamp of the need-th oldest entry
+      std::vector<cache_stamp_t> stamps;
+      stamps.reserve (size);
+      for (typename Map::const_iterator it = map.begin (); it != map.end (); ++it) {
+        stamps.push_back (it->second.stamp);
+      }
+      std::nth_element (stamps.begin (), stamps.begin () + (ev.need - 1), stamps.end ());
+      ev.threshold = stamps[ev.need - 1];
+    }
+    evict_if<Release> pred = { &ev, release };
+    size_t evicted = map.erase_if (pred);
+    if (ev.need != 0) {
+      // CLOCK : the first pass reset every stamp it spared
+      ev.left = map.size ();
+      evicted += map.erase_if (pred);
+    }
+    return evicted;
+  }
+};
+
+#endif /* _CACHE_BUDGET_HH_ */
@@ -31,19 +31,138 @@
 // modif
 #include <cassert>
 #include <map>
+#include <memory>
 // modif
 #include <sstream>
 #include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(DDD_SOA_ARCS) && defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #include "ddd/util/configuration.hh"
+#include "ddd/util/binary_stream.hh"
+#include "ddd/CacheBudget.hh"
 #include "ddd/DDD.h"
 #include "ddd/UniqueTableId.hh"
 #include "ddd/DED.h"
 
 #ifdef REENTRANT
-#include "tbb/atomic.h"
-#include "tbb/mutex.h"
+#include <atomic>
+#include <mutex>
+#include "tbb/spin_mutex.h"
+#endif
+
+
+/******************************************************************************/
+/*                             class NodePool                                  */
+/******************************************************************************/
+
+/// A slab allocator for blocks of a single size.
+/// Blocks are carved out of large slabs, that are never given back to the system.
+/// Released blocks are chained in a free list (the link is stored in the block itself)
+/// and are recycled first.
+class NodePool
+{
+  /// size of a block in bytes
+  size_t block_size_;
+  /// number of blocks carved out of the next slab
+  size_t blocks_per_slab_;
+  /// head of the free list, NULL if empty
+  char * free_list_;
+  /// the slabs allocated so far
+  std::vector<char *> slabs_;
+  /// total size of the slabs
+  size_t reserved_;
+  /// number of blocks currently in the free list
+  size_t nb_free_;
+  /// number of blocks not yet carved out of the last slab
+  size_t nb_fresh_;
+#ifdef REENTRANT
+  tbb::spin_mutex mutex_;
+#endif
+
+  /// slabs start with 16 blocks (fewer for large blocks) and double in size until they reach this size
+  static const size_t max_slab_size = 256 * 1024;
+
+  /// slabs of large blocks start smaller, with at least one block
+  static size_t first_slab_blocks (size_t block_size) {
+    size_t n = max_slab_size / block_size;
+    return n < 1 ? 1 : (n > 16 ? 16 : n);
+  }
+
+  /// read or write the free list link stored in a released block
+  static char * next (char * block) {
+    char * n;
+    memcpy (&n, block, sizeof(char *));
+    return n;
+  }
+  static void set_next (char * block, char * n) {
+    memcpy (block, &n, sizeof(char *));
+  }
+
+public:
+  NodePool (size_t block_size)
+    : block_size_ (block_size < sizeof(char *) ? sizeof(char *) : block_size)
+    , blocks_per_slab_ (first_slab_blocks (block_size_))
+    , free_list_ (NULL)
+    , reserved_ (0)
+    , nb_free_ (0)
+    , nb_fresh_ (0)
+  {}
+
+  ~NodePool () {
+    for (std::vector<char *>::iterator it = slabs_.begin() ; it != slabs_.end() ; ++it) {
+      ::operator delete (*it);
+    }
+  }
+
+  void * allocate () {
+#ifdef REENTRANT
+    tbb::spin_mutex::scoped_lock lock (mutex_);
+#endif
+    if (free_list_ != NULL) {
+      char * block = free_list_;
+      free_list_ = next (block);
+      --nb_free_;
+      return block;
+    }
+    if (nb_fresh_ == 0) {
+      slabs_.push_back (static_cast<char *> (::operator new (blocks_per_slab_ * block_size_)));
+      reserved_ += blocks_per_slab_ * block_size_;
+      nb_fresh_ = blocks_per_slab_;
+      if (2 * blocks_per_slab_ * block_size_ <= max_slab_size)
+        blocks_per_slab_ *= 2;
+    }
+    --nb_fresh_;
+    return slabs_.back() + nb_fresh_ * block_size_;
+  }
+
+  void release (void * addr) {
+#ifdef REENTRANT
+    tbb::spin_mutex::scoped_lock lock (mutex_);
 #endif
+    char * block = static_cast<char *> (addr);
+    set_next (block, free_list_);
+    free_list_ = block;
+    ++nb_free_;
+  }
+
+  size_t block_size () const { return block_size_; }
+  /// bytes obtained from the system
+  size_t reserved_bytes () const { return reserved_; }
+  /// bytes holding live blocks
+  size_t used_bytes () const { return reserved_bytes() - (nb_free_ + nb_fresh_) * block_size_; }
+};
 
 
 /******************************************************************************/
@@ -52,39 +171,153 @@
 
 typedef  UniqueTableId<_GDDD,GDDD::id_t> DDDutable;
 
+/// The read only nodes of a mapped snapshot, see mapDDDSnapshot.
+/// The node of id GDDD::frozen_bit | k is at offset offsets_[k] of the snapshot.
+/// The table of slots is an open addressing hash set of the ids of the snapshot, keyed by the
+/// hash codes stored in the nodes : nodes built later are looked up in it before they go to the
+/// unicity table, so that a node has a single id.
+class frozen_region
+{
+  static const char * base_;
+  static const uint64_t * offsets_;
+  static const GDDD::id_t * slots_;
+  static size_t mask_;
+
+  friend void mapDDDSnapshot(const std::string&, std::vector<DDD>&);
+public:
+  static bool is_frozen (GDDD::id_t id) { return id & GDDD::frozen_bit; }
+  static bool mapped () { return base_ != NULL; }
+
+  static const _GDDD * resolve (GDDD::id_t id)
+  {
+    return reinterpret_cast<const _GDDD *> (base_ + offsets_[id & ~GDDD::frozen_bit]);
+  }
+
+  /// the id of the node of the snapshot equal to g, or 0 if there is none
+  static GDDD::id_t find (const _GDDD & g);
+};
+
+const char * frozen_region::base_ = NULL;
+const uint64_t * frozen_region::offsets_ = NULL;
+const GDDD::id_t * frozen_region::slots_ = NULL;
+size_t frozen_region::mask_ = 0;
+
 
 class _GDDD
 {
   friend class GDDD;
-  friend void saveDDD(std::ostream&, std::vector<DDD>);
+  friend class GDDD::Builder;
+  friend void saveDDDSnapshot(std::ostream&, const std::vector<DDD>&);
+  friend void mapDDDSnapshot(const std::string&, std::vector<DDD>&);
 
   /// useful typedefs
-  typedef GDDD::edge_t edge_t; 
-  typedef GDDD::const_iterator const_iterator;
+  typedef GDDD::val_t val_t; 
+  typedef GDDD::run_t run_t; 
+  typedef GDDD::const_run_iterator const_iterator;
 
   /// attributes
   const int variable;
-  const unsigned short valuation_size;
-
-  /// get the address of the valuation
-  edge_t *
+  /// the number of runs of arcs, as wide as the values : with 32 bit values a node may have
+  /// more than 2^16 runs
+  const uint32_t valuation_size;
+  /// hash key of the node, computed once at construction (see compute_hash).
+  /// Stored so that unique table probes, rehash and garbage do not walk the arcs again.
+  const unsigned int hash_code;
+
+  /// get the address of the runs
+  char *
   alpha_addr () const
   {
-    return reinterpret_cast<edge_t *> (reinterpret_cast<char *> (const_cast<_GDDD *> (this)) + sizeof (_GDDD) );
+    return reinterpret_cast<char *> (const_cast<_GDDD *> (this)) + sizeof (_GDDD);
   }
 
-  /// constructor
-  _GDDD (int var, const GDDD::Valuation & val)
-  : _GDDD (var, val.begin(), val.end())
-  {}
+public:
+#ifdef DDD_SOA_ARCS
+  /// offset of the array of sons in a node with n runs, after the arrays of bounds
+  static
+  size_t
+  sons_offset (size_t n)
+  {
+    size_t offset = sizeof (_GDDD) + 2 * n * sizeof (val_t);
+    return (offset + alignof (GDDD) - 1) & ~ (alignof (GDDD) - 1);
+  }
 
-  /// constructor (with iterators)
-  template<class Iterator>
-  _GDDD (int var, Iterator begin, Iterator end)
+  /// size in bytes of a node with n runs
+  static
+  size_t
+  node_size (size_t n)
+  {
+    return sons_offset (n) + n * sizeof (GDDD);
+  }
+#else
+  /// size in bytes of a node with n runs
+  static
+  size_t
+  node_size (size_t n)
+  {
+    return sizeof (_GDDD) + n * sizeof (run_t);
+  }
+#endif
+
+private:
+
+  /// an empty struct tag type, for the constructor of nodes whose arcs are already in place
+  struct in_place_t {};
+
+  /// constructor of a node whose runs were already constructed after the header, see GDDD::Builder
+  _GDDD (int var, size_t size, in_place_t)
   : variable (var)
-  , valuation_size (end-begin)
+  , valuation_size (size)
+  , hash_code (compute_hash (var, begin(), begin() + size))
+  {}
+
+  /// an empty struct tag type, for the copy constructor used by clone
+  struct clone_t {};
+
+  /// constructor of a copy of g, used by clone.
+  /// Sons are plain ids, so the arcs of any layout are copied as a block.
+  _GDDD (const _GDDD & g, clone_t)
+  : variable (g.variable)
+  , valuation_size (g.valuation_size)
+  , hash_code (g.hash_code)
   {
-    std::copy (begin, end, alpha_addr());
+    std::memcpy (alpha_addr(), g.alpha_addr(), node_size (valuation_size) - sizeof (_GDDD));
+  }
+
+  /// builds at addr the node of variable var and arcs runs, as stored in a snapshot.
+  /// The memory at addr should be aligned for _GDDD and have node_size(runs.size()) bytes.
+  static
+  const _GDDD *
+  build_image (char * addr, int var, const std::vector<run_t> & runs)
+  {
+    size_t n = runs.size();
+#ifdef DDD_SOA_ARCS
+    val_t * lo = reinterpret_cast<val_t *> (addr + sizeof (_GDDD));
+    val_t * hi = lo + n;
+    GDDD * sons = reinterpret_cast<GDDD *> (addr + sons_offset (n));
+    for (size_t i = 0; i < n; ++i) {
+      lo[i] = runs[i].lo;
+      hi[i] = runs[i].hi;
+      new (sons + i) GDDD (runs[i].son);
+    }
+#else
+    run_t * arcs = reinterpret_cast<run_t *> (addr + sizeof (_GDDD));
+    for (size_t i = 0; i < n; ++i) {
+      new (arcs + i) run_t (runs[i]);
+    }
+#endif
+    return new (addr) _GDDD (var, n, in_place_t());
+  }
+
+  /// the hash function over a node's contents
+  static
+  unsigned int
+  compute_hash (int var, const_iterator begin, const_iterator end)
+  {
+    size_t res = ddd::wang32_hash (var);
+    for(const_iterator vi = begin; vi != end; ++vi)
+      res += (size_t)(ddd::int32_hash(vi->lo)+1011) * (vi->son.hash() + ddd::wang32_hash(vi->hi));
+    return res;
   }
 
   /// cannot copy or move
@@ -95,27 +328,26 @@ class _GDDD
   _GDDD & operator= (_GDDD &&) = delete;
 
 public:
-  /// destructor
-  ~_GDDD ()
-  {
-     for (const_iterator it = begin ();
-          it != end (); ++it)
-     {
-       it->~edge_t ();
-     }
-  }
+  /// destructor, sons are plain ids with nothing to destroy
+  ~_GDDD () {}
 
-  /// iterator API
+  /// iterator API, over runs
   const_iterator
   begin () const
   {
-    return alpha_addr ();
+#ifdef DDD_SOA_ARCS
+    const val_t * lo = reinterpret_cast<const val_t *> (alpha_addr ());
+    return const_iterator (lo, lo + valuation_size,
+                           reinterpret_cast<const GDDD *> (reinterpret_cast<const char *> (this) + sons_offset (valuation_size)));
+#else
+    return reinterpret_cast<const run_t *> (alpha_addr ());
+#endif
   }
 
   const_iterator
   end () const
   {
-    return alpha_addr () + valuation_size;
+    return begin () + valuation_size;
   }
 
 
@@ -123,6 +355,9 @@ public:
   bool
   operator== (const _GDDD & g) const
   {
+    // cheap test first, most probes in the unique table end here
+    if (hash_code != g.hash_code)
+      return false;
     if (variable != g.variable)
       return false;
     if (valuation_size != g.valuation_size)
@@ -164,16 +399,13 @@ public:
   size_t
   hash () const
   {
-    size_t res = ddd::wang32_hash (variable);
-    for(const_iterator vi = begin (); vi != end (); ++vi)
-      res += (size_t)(ddd::int32_hash(vi->first)+1011) * vi->second.hash();
-    return res;
+    return hash_code;
   }
 
   /// Memory Manager and reference counting
   void mark() const {
     for(const_iterator vi=begin();vi!=end();++vi){
-      vi->second.mark();
+      vi->son.mark();
     }
   }
 
@@ -182,45 +414,99 @@ public:
   GDDD::id_t
   create_unique_GDDD (int var, const GDDD::Valuation & val)
   {
-    // a memory cell to store the temporary _GDDD to check unicity in unique table
-    // this is reallocated only if it is too small (see maxsize)
-    // this avoids repeated allocation/deallocation
-    static _GDDD * res = new (custom_new_t (), 0) _GDDD (var, {});
-    static size_t maxsize = 0;
-
-    // if the arguments is too large for the memory cell
-    if (val.size () > maxsize)
-    {
-      // deallocate
-      delete res;
-      // update size
-      maxsize = val.size ();
-      // reallocate to the appropriate size
-      res = new (custom_new_t (), maxsize) _GDDD (var, val);
-    }
-    else // there is already enough room
-    {
-      // an object built with a placement new should be explicitly deleted
-      res->~_GDDD ();
-      // placement new
-      new (res) _GDDD (var, val);
-    }
-
-    GDDD::id_t ret = DDDutable::instance() (*res);
-    return ret;
+    GDDD::Builder builder (var);
+    for (GDDD::Valuation::const_iterator it = val.begin(); it != val.end(); ++it)
+      builder.add (it->first, it->second);
+    return builder.unique();
   }
 
   static const _GDDD * resolve(GDDD::id_t id) 
   {
+    if (frozen_region::is_frozen(id))
+      return frozen_region::resolve(id);
     return DDDutable::instance().resolve(id);
   }
   
-  /// cloning
+  /// cloning, the copy is allocated in the pool matching its number of runs
   _GDDD *
   clone () const
   {
-    return new (custom_new_t (), valuation_size) _GDDD (variable, begin (), end ());
+    void * addr = pool (valuation_size).allocate ();
+    return new (addr) _GDDD (*this, clone_t ());
+  }
+
+  /// the matching release of a clone, gives the memory back to its pool
+  static
+  void
+  destroy (const _GDDD * g)
+  {
+    size_t length = g->valuation_size;
+    g->~_GDDD ();
+    pool (length).release (const_cast<_GDDD *> (g));
+  }
+
+  /// \name Node pools
+  /// Nodes with up to max_exact_arity runs are stored in pools of exactly the right size,
+  /// larger nodes go into pools sized for the next power of two arity.
+  //@{
+  static const size_t max_exact_arity = 32;
+  /// power of two of the smallest binned arity (64 > max_exact_arity)
+  static const size_t first_bin_log = 6;
+  /// valuation_size is an uint32_t, so arity is at most 2^32
+  static const size_t last_bin_log = 32;
+  static const size_t nb_pools = max_exact_arity + 1 + last_bin_log - first_bin_log + 1;
+
+  /// the index of the pool holding nodes with the given number of runs
+  static
+  size_t
+  pool_index (size_t length)
+  {
+    if (length <= max_exact_arity)
+      return length;
+    size_t log = first_bin_log;
+    while ((size_t (1) << log) < length)
+      ++log;
+    return max_exact_arity + 1 + log - first_bin_log;
+  }
+
+  /// the number of runs a node of the pool at index i can hold
+  static
+  size_t
+  pool_arity (size_t index)
+  {
+    if (index <= max_exact_arity)
+      return index;
+    return size_t (1) << (index - max_exact_arity - 1 + first_bin_log);
+  }
+
+  /// all pools, built on first use (nodes are created during static initialization)
+  static
+  std::vector<NodePool *> &
+  pools ()
+  {
+    static std::vector<NodePool *> * const pools_ = new_pools ();
+    return *pools_;
+  }
+
+  static
+  std::vector<NodePool *> *
+  new_pools ()
+  {
+    std::vector<NodePool *> * res = new std::vector<NodePool *> ();
+    res->reserve (nb_pools);
+    for (size_t i = 0; i < nb_pools; ++i) {
+      res->push_back (new NodePool (node_size (pool_arity (i))));
+    }
+    return res;
+  }
+
+  static
+  NodePool &
+  pool (size_t length)
+  {
+    return * pools ()[pool_index (length)];
   }
+  //@}
 
 private:
   /// an empty struct tag type used to disambiguate between different variants of the operator new
@@ -235,7 +521,7 @@ private:
   /// syntax: new (custom_new_t(), nb_sons) _GDDD (constructor arguments)
   ///     it looks like a placement new, but this syntax
   ///     is only used to pass arguments to operator new
-  /// _GDDD should only be constructed by create_unique_GDDD or clone
+  /// _GDDD should only be constructed by GDDD::Builder or clone
   /// please refer to these two functions for invokation examples
   static
   void *
@@ -243,14 +529,14 @@ private:
   {
     // allocate enough memory to store the successors
     // with the global (default) operator new
-    size_t siz = sizeof(_GDDD) + length*sizeof(edge_t);
+    size_t siz = node_size (length);
     return ::operator new (siz);
   }
 
   /// classical placement new
   /// NB: it is the responsibility of the caller that there is enough room to build the _GDDD.
   ///   e.g.    new (ad) _GDDD(v, val)
-  ///     the memory chunk at 'ad' must be of size at least sizeof(_GDDD)+sizeof(edge_t)*val.size()
+  ///     the memory chunk at 'ad' must be of size at least node_size(nb_runs)
   static
   void *
   operator new (size_t, void * addr)
@@ -270,11 +556,192 @@ public:
   }
 };
 
+GDDD::id_t frozen_region::find (const _GDDD & g)
+{
+  for (size_t i = g.hash() & mask_ ; ; i = (i + 1) & mask_) {
+    GDDD::id_t id = slots_[i];
+    if (id == 0 || *resolve(id) == g)
+      return id;
+  }
+}
+
+namespace unique {
+  // _GDDD are allocated by clone in the node pools
+  template<>
+  struct destroy<_GDDD>
+  {
+    void
+    operator()(const _GDDD* e1) const
+    {
+      _GDDD::destroy (e1);
+    }
+  };
+}
+
+/******************************************************************************/
+/*                             class GDDD::Builder                            */
+/******************************************************************************/
+
+namespace {
+  /// The buffers of builders that are not in use, for the calling thread.
+  /// Builders nest, so buffers are taken and given back in stack order.
+  struct builder_pool {
+    /// a buffer and its capacity in runs
+    std::vector<std::pair<char *, size_t> > free;
+
+    ~builder_pool () {
+      for (size_t i = 0; i < free.size(); ++i)
+        ::operator delete (free[i].first);
+    }
+
+    static builder_pool & instance () {
+#ifdef REENTRANT
+      static thread_local builder_pool pool;
+#else
+      static builder_pool pool;
+#endif
+      return pool;
+    }
+  };
+
+  /// capacity of new buffers, in runs
+  const size_t builder_capacity = 32;
+
+  /// the capacity after growth : nodes count their runs on 32 bits
+  size_t next_capacity (size_t capacity) {
+    const size_t max_runs = std::numeric_limits<uint32_t>::max();
+    if (capacity >= max_runs)
+      throw std::length_error("GDDD::Builder : too many runs in a node");
+    return capacity > max_runs / 2 ? max_runs : 2 * capacity;
+  }
+
+  char * allocate_buffer (size_t capacity) {
+    return static_cast<char *> (::operator new (_GDDD::node_size (capacity)));
+  }
+}
+
+GDDD::Builder::Builder (int variable)
+  : variable_ (variable), size_ (0)
+{
+  builder_pool & pool = builder_pool::instance();
+  if (pool.free.empty()) {
+    capacity_ = builder_capacity;
+    buffer_ = allocate_buffer (capacity_);
+  } else {
+    buffer_ = pool.free.back().first;
+    capacity_ = pool.free.back().second;
+    pool.free.pop_back();
+  }
+  layout();
+}
+
+GDDD::Builder::~Builder ()
+{
+  clear();
+  builder_pool::instance().free.push_back (std::make_pair (buffer_, capacity_));
+}
+
+#ifdef DDD_SOA_ARCS
+
+void GDDD::Builder::layout ()
+{
+  lo_ = reinterpret_cast<val_t *> (buffer_ + sizeof(_GDDD));
+  hi_ = lo_ + capacity_;
+  sons_ = reinterpret_cast<GDDD *> (buffer_ + _GDDD::sons_offset (capacity_));
+}
+
+void GDDD::Builder::clear ()
+{
+  size_ = 0;
+}
+
+void GDDD::Builder::grow ()
+{
+  val_t * lo = lo_;
+  val_t * hi = hi_;
+  GDDD * sons = sons_;
+  char * buffer = buffer_;
+  capacity_ = next_capacity (capacity_);
+  buffer_ = allocate_buffer (capacity_);
+  layout();
+  std::memcpy (lo_, lo, size_ * sizeof(val_t));
+  std::memcpy (hi_, hi, size_ * sizeof(val_t));
+  std::memcpy (static_cast<void *> (sons_), sons, size_ * sizeof(GDDD));
+  ::operator delete (buffer);
+}
+
+GDDD::id_t GDDD::Builder::unique ()
+{
+  // the arrays are sized for the capacity : pack them for size_ runs, as in a node
+  val_t * hi = lo_ + size_;
+  GDDD * sons = reinterpret_cast<GDDD *> (buffer_ + _GDDD::sons_offset (size_));
+  std::memmove (hi, hi_, size_ * sizeof(val_t));
+  std::memmove (static_cast<void *> (sons), sons_, size_ * sizeof(GDDD));
+  // the header is built in front of the runs, the node is only copied on a miss of the table
+  _GDDD * node = new (buffer_) _GDDD (variable_, size_, _GDDD::in_place_t());
+  id_t res = frozen_region::mapped() ? frozen_region::find(*node) : 0;
+  if (res == 0)
+    res = DDDutable::instance() (*node);
+  node->~_GDDD();
+  size_ = 0;
+  return res;
+}
+
+#else
+
+void GDDD::Builder::layout ()
+{
+  runs_ = reinterpret_cast<run_t *> (buffer_ + sizeof(_GDDD));
+}
+
+void GDDD::Builder::clear ()
+{
+  for (size_t i = 0; i < size_; ++i)
+    runs_[i].~run_t();
+  size_ = 0;
+}
+
+void GDDD::Builder::grow ()
+{
+  run_t * runs = runs_;
+  char * buffer = buffer_;
+  capacity_ = next_capacity (capacity_);
+  buffer_ = allocate_buffer (capacity_);
+  layout();
+  for (size_t i = 0; i < size_; ++i) {
+    new (runs_ + i) run_t (runs[i]);
+    runs[i].~run_t();
+  }
+  ::operator delete (buffer);
+}
+
+GDDD::id_t GDDD::Builder::unique ()
+{
+  // the header is built in front of the runs, the node is only copied on a miss of the table
+  _GDDD * node = new (buffer_) _GDDD (variable_, size_, _GDDD::in_place_t());
+  id_t res = frozen_region::mapped() ? frozen_region::find(*node) : 0;
+  if (res == 0)
+    res = DDDutable::instance() (*node);
+  // also destroys the runs
+  clear();
+  node->~_GDDD();
+  return res;
+}
+
+#endif
+
+GDDD GDDD::Builder::finalize ()
+{
+  if (size_ == 0)
+    return null;
+  return GDDD (unique());
+}
+
 std::map<int,std::string> mapVarName;
 
 #ifdef REENTRANT
 
-static tbb::atomic<size_t> Max_DDD;
+static std::atomic<size_t> Max_DDD;
 
 class DDD_parallel_init
 {
@@ -300,13 +767,15 @@ static DDD_parallel_init DDD_init;
 /******************************************************************************/
 
 /* Memory manager */
-unsigned int GDDD::statistics() {
+size_t GDDD::statistics() {
   return DDDutable::instance().size();
 }
 
 // Todo
 void GDDD::mark()const{
-  DDDutable::instance().mark(concret);
+  // nodes of a snapshot are not collected, and only have sons in the snapshot
+  if (! frozen_region::is_frozen(concret))
+    DDDutable::instance().mark(concret);
 }
 
 
@@ -314,14 +783,72 @@ size_t GDDD::peak() {
   return DDDutable::instance().peak_size();
 }
 
+size_t GDDD::refUpdates() {
+  return DDDutable::instance().ref_updates();
+}
+
+
+void GDDD::setGCPolicy(unsigned int promotion_age, unsigned int major_period)
+{
+  DDDutable::instance().set_gc_policy(promotion_age, major_period);
+}
+
+void GDDD::setGCThreads(unsigned int nb_threads)
+{
+  DDDutable::instance().set_gc_threads(nb_threads);
+}
 
-void GDDD::pstats(bool)
+void GDDD::pstats(bool reinit)
 {
   std::cout << "Peak number of DDD nodes in unicity table :" << peak() << std::endl; 
   std::cout << "sizeof(_GDDD):" << sizeof(_GDDD) << std::endl;
   std::cout << "sizeof(DDD::edge_t):" << sizeof(GDDD::edge_t) << std::endl;
+  std::cout << "sizeof(DDD::run_t):" << sizeof(GDDD::run_t) << std::endl;
   std::cout << "sizeof(DDD::val_t):" << sizeof(GDDD::val_t) << std::endl;
 
+  std::cout << "DDD node pools (arity : reserved bytes / used bytes) :" << std::endl;
+  size_t reserved = 0;
+  size_t used = 0;
+  for (size_t i = 0; i < _GDDD::nb_pools; ++i) {
+    const NodePool & pool = * _GDDD::pools()[i];
+    if (pool.reserved_bytes() == 0)
+      continue;
+    std::cout << "  " << (i <= _GDDD::max_exact_arity ? "" : "<=") << _GDDD::pool_arity(i)
+              << " : " << pool.reserved_bytes() << " / " << pool.used_bytes() << std::endl;
+    reserved += pool.reserved_bytes();
+    used += pool.used_bytes();
+  }
+  std::cout << "  total : " << reserved << " / " << used << std::endl;
+
+  // collections since last reinit, only the last ones are detailed
+  const std::vector<DDDutable::gc_stat> & history = DDDutable::instance().gc_history();
+  const size_t max_detailed = 20;
+  size_t nb_major = 0;
+  size_t reclaimed_total = 0;
+  double pause_total = 0;
+  for (size_t i = 0; i < history.size(); ++i) {
+    nb_major += history[i].major;
+    reclaimed_total += history[i].reclaimed;
+    pause_total += history[i].pause;
+  }
+  std::cout << "DDD garbage collections : " << history.size() << " (" << nb_major << " major), reclaimed "
+            << reclaimed_total << " nodes, total pause " << pause_total << " s" << std::endl;
+  if (! history.empty()) {
+    std::cout << "  (kind : swept / reclaimed / promoted / pause(s))" << std::endl;
+    if (history.size() > max_detailed)
+      std::cout << "  ..." << std::endl;
+  }
+  for (size_t i = history.size() > max_detailed ? history.size() - max_detailed : 0; i < history.size(); ++i) {
+    std::cout << "  " << (history[i].major ? "major" : "minor") << " : " << history[i].scanned << " / "
+              << history[i].reclaimed << " / " << history[i].promoted << " / " << history[i].pause << std::endl;
+  }
+  if (reinit)
+    DDDutable::instance().clear_gc_history();
+
+  std::cout << "DDD reference count updates : " << refUpdates() << std::endl;
+  if (reinit)
+    DDDutable::instance().clear_ref_updates();
+
   
 #ifdef HASH_STAT
   std::cout << std::endl << "DDD Unicity table stats :" << std::endl;
@@ -343,7 +870,7 @@ void GDDD::print(std::ostream& os,std::string s) const{
     const_iterator end = this->end();
     for(GDDD::const_iterator vi=begin();vi!=end;++vi){
       std::stringstream tmp;
-      tmp << getvarName(variable())<<'('<<vi->first<<")";
+      tmp << getvarName(variable())<<'('<<int(vi->first)<<")";
       vi->second.print(os,s+tmp.str() +" ");
     }
   }
@@ -380,24 +907,136 @@ int GDDD::variable() const{
 }
 
 size_t GDDD::nbsons () const { 
+  const _GDDD * node = _GDDD::resolve(concret);
+  size_t res = 0;
+  for (const_run_iterator it = node->begin(); it != node->end(); ++it)
+    res += it->size();
+  return res;
+}
+
+size_t GDDD::nbruns () const { 
   return _GDDD::resolve(concret)->valuation_size;
 }
 
 GDDD::const_iterator GDDD::begin() const{
-  return _GDDD::resolve(concret)->begin();
+  const _GDDD * node = _GDDD::resolve(concret);
+  return const_iterator(node->begin(), node->end());
 }
 
 GDDD::const_iterator GDDD::end() const{
+  const _GDDD * node = _GDDD::resolve(concret);
+  return const_iterator(node->end(), node->end());
+}
+
+GDDD::const_run_iterator GDDD::runs_begin() const{
+  return _GDDD::resolve(concret)->begin();
+}
+
+GDDD::const_run_iterator GDDD::runs_end() const{
   return _GDDD::resolve(concret)->end();
 }
 
+GDDD::const_run_iterator GDDD::find(val_t val) const{
+  const _GDDD * node = _GDDD::resolve(concret);
+  const_run_iterator last = node->end();
+  const_run_iterator it = seek(node->begin(), last, val);
+#ifdef DDD_SOA_ARCS
+  // only read the low bound, the son lies in another array
+  if (it != last && *it.lo_ptr() <= val)
+#else
+  if (it != last && it->lo <= val)
+#endif
+    return it;
+  return last;
+}
+
+namespace {
+  /// seek narrows the range by a branchless binary search down to this many runs, then counts
+  const size_t seek_block = 16;
+
+#ifdef DDD_SOA_ARCS
+  // the lanes of hi[] lower than key, a byte of the mask per byte of val_t
+#if defined(__AVX2__)
+  inline int lower_mask (__m256i h, GDDD::val_t key) {
+    switch (sizeof(GDDD::val_t)) {
+    case 1 : return _mm256_movemask_epi8 (_mm256_cmpgt_epi8 (_mm256_set1_epi8 (key), h));
+    case 2 : return _mm256_movemask_epi8 (_mm256_cmpgt_epi16 (_mm256_set1_epi16 (key), h));
+    default : return _mm256_movemask_epi8 (_mm256_cmpgt_epi32 (_mm256_set1_epi32 (key), h));
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  inline int lower_mask (__m128i h, GDDD::val_t key) {
+    switch (sizeof(GDDD::val_t)) {
+    case 1 : return _mm_movemask_epi8 (_mm_cmplt_epi8 (h, _mm_set1_epi8 (key)));
+    case 2 : return _mm_movemask_epi8 (_mm_cmplt_epi16 (h, _mm_set1_epi16 (key)));
+    default : return _mm_movemask_epi8 (_mm_cmplt_epi32 (h, _mm_set1_epi32 (key)));
+    }
+  }
+#endif
+
+  /// the number of bounds of hi[0..len) lower than val
+  size_t count_below (const GDDD::val_t * hi, size_t len, GDDD::val_t val) {
+    size_t n = 0;
+    size_t k = 0;
+#if defined(__AVX2__)
+    const size_t lanes256 = 32 / sizeof(GDDD::val_t);
+    for (; k + lanes256 <= len; k += lanes256) {
+      __m256i h = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (hi + k));
+      n += __builtin_popcount (lower_mask (h, val)) / sizeof(GDDD::val_t);
+    }
+#endif
+#if defined(__SSE2__)
+    const size_t lanes128 = 16 / sizeof(GDDD::val_t);
+    for (; k + lanes128 <= len; k += lanes128) {
+      __m128i h = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (hi + k));
+      n += __builtin_popcount (lower_mask (h, val)) / sizeof(GDDD::val_t);
+    }
+#endif
+    for (; k < len; ++k)
+      n += hi[k] < val;
+    return n;
+  }
+#endif
+}
+
+GDDD::const_run_iterator GDDD::seek(const_run_iterator first, const_run_iterator last, wide_val_t val){
+  // values out of the range of val_t : all or none of the runs are below
+  if (val > std::numeric_limits<val_t>::max())
+    return last;
+  if (val <= std::numeric_limits<val_t>::min())
+    return first;
+  size_t len = last - first;
+#ifdef DDD_SOA_ARCS
+  const val_t * start = first.hi_ptr();
+  const val_t * base = start;
+  while (len > seek_block) {
+    size_t half = len / 2;
+    base += (base[half - 1] < val) ? half : 0;
+    len -= half;
+  }
+  return first + ((base - start) + count_below (base, len, val_t (val)));
+#else
+  const run_t * base = first;
+  while (len > seek_block) {
+    size_t half = len / 2;
+    base += (base[half - 1].hi < val) ? half : 0;
+    len -= half;
+  }
+  size_t n = 0;
+  for (size_t k = 0; k < len; ++k)
+    n += base[k].hi < val;
+  return base + n;
+#endif
+}
+
 /* Visualisation */
 
 class MySize{
 
 private:
 #ifdef REENTRANT
-	tbb::atomic<unsigned long int> res;
+	std::atomic<unsigned long int> res;
 #else
   unsigned long int res;
 #endif
@@ -409,9 +1048,9 @@ private:
 	{
 	  s.insert(g);
 	  res++;
-	  GDDD::const_iterator end = g.end();
-	  for(GDDD::const_iterator gi=g.begin();gi!=end;++gi)
-	    mysize(gi->second);
+	  GDDD::const_run_iterator end = g.runs_end();
+	  for(GDDD::const_run_iterator gi=g.runs_begin();gi!=end;++gi)
+	    mysize(gi->son);
 	}
   }
 
@@ -434,9 +1073,18 @@ unsigned long int GDDD::size() const{
 class MyNbStates{
 private:
   int val; // val=0 donne nbState , val=1 donne noSharedSize
-  typedef ext_hash_map<GDDD,long double> cache_type;
+  typedef ext_hash_map<GDDD,Stamped<long double> > cache_type;
   static cache_type cache;
 
+  /// bounds the cache by the cache budget
+  class Budget : public BudgetedCache {
+  public:
+    Budget () : BudgetedCache ("DDD nbStates cache", sizeof(std::pair<const GDDD, Stamped<long double> >) + 2 * sizeof(void *)) {}
+    size_t size () const { return cache.size(); }
+    size_t evict (size_t target) { return CacheBudget::evict(cache, policy(), target, CacheBudget::no_release()); }
+  };
+  static Budget cache_budget;
+
 
   long double nbStates(const GDDD& g){
 
@@ -450,14 +1098,18 @@ private:
   
 	  if( access.empty() ) {
 	    long double res=0;
-	    GDDD::const_iterator end = g.end();
-	    for(GDDD::const_iterator gi=g.begin();gi!=end;++gi)
-	      res+=nbStates(gi->second)+val;
+	    // all the arcs of a run lead to the same son
+	    GDDD::const_run_iterator end = g.runs_end();
+	    for(GDDD::const_run_iterator gi=g.runs_begin();gi!=end;++gi)
+	      res+=(nbStates(gi->son)+val)*gi->size();
 	    cache.insert(access,g);
-	    access->second = res;
+	    access->second.value = res;
+	    access->second.stamp = CacheBudget::tick();
+	    CacheBudget::inserted(cache_budget.entry_bytes());
 	    return res;
 	  } else {
-	    return access->second;
+	    access->second.stamp = CacheBudget::tick();
+	    return access->second.value;
 	  }
 
 	}
@@ -476,14 +1128,15 @@ public:
   }
 };
 
-ext_hash_map<GDDD,long double> MyNbStates::cache = ext_hash_map<GDDD,long double> ();
+MyNbStates::cache_type MyNbStates::cache;
+MyNbStates::Budget MyNbStates::cache_budget;
 
 long double
 GDDD::nbStates() const
 {
 #ifdef REENTRANT
-tbb::mutex nb_states_mutex_;
-  tbb::mutex::scoped_lock lock(nb_states_mutex_);
+  static std::mutex nb_states_mutex_;
+  std::lock_guard<std::mutex> lock(nb_states_mutex_);
 #endif
   static MyNbStates myNbStates(0);
   return myNbStates(*this);
@@ -496,12 +1149,25 @@ long double GDDD::noSharedSize() const{
 
 
 void GDDD::garbage(){
+  garbage_mark();
+  garbage_sweep();
+}
+
+void GDDD::garbage_mark(){
   MyNbStates::clear();
   // mark terminals
   null.mark();
   one.mark();
   top.mark();
-  DDDutable::instance().garbage();
+  DDDutable::instance().garbage_mark();
+}
+
+void GDDD::garbage_sweep(){
+  DDDutable::instance().garbage_sweep();
+}
+
+bool GDDD::is_marked() const{
+  return frozen_region::is_frozen(concret) || DDDutable::instance().is_marked(concret);
 }
 
 
@@ -516,17 +1182,27 @@ const GDDD GDDD::top(_GDDD::create_unique_GDDD(-1,GDDD::Valuation()));
 /*                   class DDD:public GDDD                                    */
 /******************************************************************************/
 
+void DDD::ref (id_t id) {
+  if (counted(id))
+    DDDutable::instance().ref(id);
+}
+
+void DDD::deref (id_t id) {
+  if (counted(id))
+    DDDutable::instance().deref(id);
+}
+
 DDD::DDD(const DDD &g):GDDD(g.concret),DataSet(){
-  DDDutable::instance().ref(concret);
+  ref(concret);
 }
 
 DDD::DDD(const GDDD &g):GDDD(g.concret){
-  DDDutable::instance().ref(concret);
+  ref(concret);
 }
 
 GDDD::GDDD(int var,val_t val,const GDDD &d):concret(null.concret){ //var-val->d
   if(d!=null){
-    GDDD::Valuation tmp;
+    Builder builder(var);
 #ifdef EVDDD
     GDDD succ = d;
     if (var == DISTANCE) {
@@ -536,51 +1212,51 @@ GDDD::GDDD(int var,val_t val,const GDDD &d):concret(null.concret){ //var-val->d
 	  succ = succ.normalizeDistance(-minsucc);
 	}
     }
-    edge_t x(val,succ);
+    builder.add(val,succ);
 #else
-    edge_t x(val,d);
+    builder.add(val,d);
 #endif
-    tmp.push_back(x);
-    concret=_GDDD::create_unique_GDDD(var,tmp);
+    concret=builder.finalize().concret;
   }
   //  concret->refCounter++;
 }
 
 GDDD::GDDD(int var,val_t val1,val_t val2,const GDDD &d):concret(null.concret){ //var-[val1,val2]->d
   if(val1<=val2 && null!=d){
-    GDDD::Valuation tmp;
-    for(val_t val=val1;val<=val2;++val){
-      edge_t x(val,d);
-      tmp.push_back(x);
-    }
-    concret=_GDDD::create_unique_GDDD(var,tmp);
+    Builder builder(var);
+    builder.add(val1,val2,d);
+    concret=builder.finalize().concret;
   }
   //  concret->refCounter++;
 }
 
 DDD::DDD(int var,val_t val,const GDDD &d):GDDD(var,val,d){
-  DDDutable::instance().ref(concret);
+  ref(concret);
 }
 
 DDD::DDD(int var,val_t val1,val_t val2,const GDDD &d):GDDD(var,val1,val2,d){
-    DDDutable::instance().ref(concret);
+  ref(concret);
 }
 
 DDD::~DDD(){
-  DDDutable::instance().deref(concret);
+  deref(concret);
 }
 
 DDD &DDD::operator=(const GDDD &g){
-  DDDutable::instance().deref(concret);
-  concret=g.concret;
-  DDDutable::instance().ref(concret);
+  if (concret != g.concret) {
+    deref(concret);
+    concret=g.concret;
+    ref(concret);
+  }
   return *this;
 }
 
 DDD &DDD::operator=(const DDD &g){
-  DDDutable::instance().deref(concret);
-  concret=g.concret;
-  DDDutable::instance().ref(concret);
+  if (concret != g.concret) {
+    deref(concret);
+    concret=g.concret;
+    ref(concret);
+  }
   return *this;
 }
 
@@ -668,49 +1344,76 @@ size_t DDD::set_hash() const {
 
 
 
-//My funs
+/* Serialization */
 
-unsigned long int GDDD::nodeIndex(const std::vector<GDDD::id_t> & list) const{
-    assert(this);
-    assert(concret!=0);
-    unsigned long int i=0;
-    for (i=0; i<list.size();++i)
-      if (concret==list[i]) return i;
-    return std::numeric_limits<unsigned long>::max();
-}
+namespace {
+  /// Numbers the nodes of DDD in topological order : the sons of a node come before it.
+  class node_numbering {
+    typedef ext_hash_map<GDDD, unsigned long> index_t;
+    index_t index_;
+    std::vector<GDDD> nodes_;
 
+    void number (const GDDD & g) {
+      index_t::accessor access;
+      index_.insert(access, g);
+      access->second = nodes_.size();
+      nodes_.push_back(g);
+    }
+  public:
+    /// Terminals are numbered as they are met, or first as 0 (null), 1 (one) and 2 (top).
+    explicit node_numbering (bool terminals_first) {
+      if (terminals_first) {
+        number(GDDD::null);
+        number(GDDD::one);
+        number(GDDD::top);
+      }
+    }
 
-void GDDD::saveNode(std::ostream& os, std::vector<GDDD::id_t>& list)const {
-    assert(this);
-    //assert(concret);
-    unsigned long int index = nodeIndex(list);
-    if (index == std::numeric_limits<unsigned long>::max() ) {
+    bool numbered (const GDDD & g) const {
+      index_t::const_accessor access;
+      return index_.find(access, g);
+    }
 
-        if (*this==one) list.push_back(concret);
-        else 
-        if (*this==null) list.push_back(concret);
-        else 
-        if (*this==top) list.push_back(concret);
-        else {
-	  assert(concret);
-	  GDDD::const_iterator end = this->end();
-	  for (GDDD::const_iterator vi=begin();vi!=end;++vi) 
-	    vi->second.saveNode(os, list);
-	  list.push_back(concret);
-        }
+    /// g should be numbered
+    unsigned long index (const GDDD & g) const {
+      index_t::const_accessor access;
+      index_.find(access, g);
+      return access->second;
     }
-}
 
+    /// number g and the nodes below it, depth first with an explicit stack
+    void add (const GDDD & g) {
+      if (numbered(g))
+        return;
+      std::vector<std::pair<GDDD, GDDD::const_run_iterator> > stack;
+      stack.push_back(std::make_pair(g, g.runs_begin()));
+      while (! stack.empty()) {
+        std::pair<GDDD, GDDD::const_run_iterator> & top = stack.back();
+        if (top.second != top.first.runs_end()) {
+          GDDD son = top.second->son;
+          ++top.second;
+          if (! numbered(son))
+            stack.push_back(std::make_pair(son, son.runs_begin()));
+        } else {
+          number(top.first);
+          stack.pop_back();
+        }
+      }
+    }
 
+    const std::vector<GDDD> & nodes () const { return nodes_; }
+  };
+}
 
 void saveDDD(std::ostream& os, std::vector<DDD> list) {
-  std::vector<GDDD::id_t> SavedDDD;
-  for (unsigned int i= 0; i<list.size(); ++i) {
-    list[i].saveNode(os, SavedDDD);
+  node_numbering numbering (false);
+  for (unsigned long int i= 0; i<list.size(); ++i) {
+    numbering.add(list[i]);
   }
+  const std::vector<GDDD> & SavedDDD = numbering.nodes();
   os<<SavedDDD.size()<<std::endl;
   for (unsigned long int i=0; i<SavedDDD.size();++i) {
-    GDDD d = SavedDDD[i];
+    const GDDD & d = SavedDDD[i];
     if (d==GDDD::one) 
       os<<i<<" one"<<std::endl;
     else if (d==GDDD::null) 
@@ -719,14 +1422,17 @@ void saveDDD(std::ostream& os, std::vector<DDD> list) {
       os<<i<<" top"<<std::endl;
     else {
       os<<i<<"[ "<< d.variable();
-      for (GDDD::const_iterator vi=d.begin();vi!=d.end();++vi)
-	os<<" "<<vi->first<<" "<<vi->second.nodeIndex(SavedDDD);
+      for (GDDD::const_run_iterator vi=d.runs_begin();vi!=d.runs_end();++vi) {
+	unsigned long int son = numbering.index(vi->son);
+	for (GDDD::wide_val_t val = vi->lo; val <= vi->hi; ++val)
+	  os<<" "<<val<<" "<<son;
+      }
       os<<" ]"<<std::endl;
     }
   }
     
   os<<std::endl<<"Saved:";
-  for (unsigned int i= 0; i<list.size(); ++i) os<<" "<<list[i].nodeIndex(SavedDDD);
+  for (unsigned long int i= 0; i<list.size(); ++i) os<<" "<<numbering.index(list[i]);
   os<<std::endl;
     
 }
@@ -768,6 +1474,329 @@ void loadDDD(std::istream& is, std::vector<DDD>& list) {
     
 }
 
+namespace {
+  /// Magic number and version of the binary format of saveDDDBinary.
+  const char binary_magic[4] = { 'D', 'D', 'D', 'b' };
+  const unsigned char binary_version = 1;
+
+  /// how far back from the node numbered i its sons are numbered
+  class son_back {
+    const node_numbering & numbering_;
+    size_t i_;
+  public:
+    son_back (const node_numbering & numbering, size_t i) : numbering_(numbering), i_(i) {}
+    uint64_t operator() (const GDDD & son) const { return i_ - numbering_.index(son); }
+  };
+}
+
+void saveDDDBinary(std::ostream& os, const std::vector<DDD>& list) {
+  node_numbering numbering (true);
+  for (size_t i = 0; i < list.size(); ++i) {
+    numbering.add(list[i]);
+  }
+  const std::vector<GDDD> & nodes = numbering.nodes();
+  d3::util::binary_writer out (os);
+  for (size_t i = 0; i < sizeof(binary_magic); ++i) {
+    out.byte(binary_magic[i]);
+  }
+  out.byte(binary_version);
+  // terminals are implicit
+  out.varint(nodes.size() - 3);
+  for (size_t i = 3; i < nodes.size(); ++i) {
+    const GDDD & d = nodes[i];
+    out.svarint(d.variable());
+    d3::util::write_runs(out, d, son_back (numbering, i));
+  }
+  out.varint(list.size());
+  for (size_t i = 0; i < list.size(); ++i) {
+    out.varint(numbering.index(list[i]));
+  }
+}
+
+void loadDDDBinary(std::istream& is, std::vector<DDD>& list) {
+  d3::util::binary_reader in (is, "loadDDDBinary");
+  for (size_t i = 0; i < sizeof(binary_magic); ++i) {
+    if (in.byte() != (unsigned char) binary_magic[i])
+      throw std::runtime_error("loadDDDBinary : not a binary DDD stream");
+  }
+  if (in.byte() != binary_version)
+    throw std::runtime_error("loadDDDBinary : unsupported version");
+  uint64_t size = in.varint();
+  std::vector<GDDD> nodes;
+  nodes.reserve(std::min<uint64_t> (size, 1 << 20) + 3);
+  nodes.push_back(GDDD::null);
+  nodes.push_back(GDDD::one);
+  nodes.push_back(GDDD::top);
+  for (uint64_t n = 0; n < size; ++n) {
+    GDDD::Builder value ((int) in.svarint());
+    d3::util::read_runs(in, value, nodes);
+    nodes.push_back(value.finalize());
+  }
+  uint64_t nbroots = in.varint();
+  list.resize(nbroots);
+  for (uint64_t r = 0; r < nbroots; ++r) {
+    uint64_t index = in.varint();
+    if (index >= nodes.size())
+      throw std::runtime_error("loadDDDBinary : bad root index");
+    list[r] = nodes[index];
+  }
+}
+
+namespace {
+  /// Header of the snapshot files of saveDDDSnapshot, followed by the sections it locates :
+  /// the ids of the roots, the offsets of the nodes, the node images and the slots of the hash
+  /// set of frozen_region. Positions are in bytes from the start of the file, and 8 byte aligned.
+  struct snapshot_header {
+    char magic[8];
+    uint32_t version;
+    /// what the images depend on : the layout of the arcs and the sizes of values and ids
+    uint32_t soa_arcs;
+    uint32_t sizeof_val;
+    uint32_t sizeof_id;
+    uint32_t sizeof_node;
+    uint32_t padding;
+    /// the ids of the terminals the images refer to
+    uint64_t null_id, one_id, top_id;
+    uint64_t nb_nodes, nb_roots, nb_slots;
+    uint64_t roots_pos, offsets_pos, nodes_pos, slots_pos;
+    uint64_t file_size;
+  };
+
+  const char snapshot_magic[8] = { 'D', 'D', 'D', 's', 'n', 'a', 'p', 0 };
+  /// version 2 : run counts of the node images are 32 bit
+  const uint32_t snapshot_version = 2;
+
+#ifdef DDD_SOA_ARCS
+  const uint32_t snapshot_soa_arcs = 1;
+#else
+  const uint32_t snapshot_soa_arcs = 0;
+#endif
+
+  size_t align8 (size_t n) { return (n + 7) & ~ size_t (7); }
+
+  void write_zeros (std::ostream & os, size_t n) {
+    static const char zeros[8] = { 0 };
+    os.write(zeros, n);
+  }
+}
+
+void saveDDDSnapshot(std::ostream& os, const std::vector<DDD>& list) {
+  node_numbering numbering (true);
+  for (size_t i = 0; i < list.size(); ++i) {
+    numbering.add(list[i]);
+  }
+  const std::vector<GDDD> & nodes = numbering.nodes();
+  const size_t nb_nodes = nodes.size() - 3;
+  if (nb_nodes >= GDDD::frozen_bit)
+    throw std::runtime_error("saveDDDSnapshot : too many nodes");
+  // the id in the snapshot of the node numbered i ; terminals keep their id
+  std::vector<GDDD::id_t> ids (nodes.size());
+  for (size_t i = 0; i < 3; ++i)
+    ids[i] = nodes[i].concret;
+  for (size_t i = 3; i < nodes.size(); ++i)
+    ids[i] = GDDD::frozen_bit | (i - 3);
+
+  // the hash set is at most half full
+  size_t nb_slots = 16;
+  while (nb_slots < 2 * nb_nodes)
+    nb_slots *= 2;
+  std::vector<GDDD::id_t> slots (nb_slots, 0);
+  std::vector<uint64_t> offsets (nb_nodes);
+
+  snapshot_header h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, snapshot_magic, sizeof(h.magic));
+  h.version = snapshot_version;
+  h.soa_arcs = snapshot_soa_arcs;
+  h.sizeof_val = sizeof(GDDD::val_t);
+  h.sizeof_id = sizeof(GDDD::id_t);
+  h.sizeof_node = sizeof(_GDDD);
+  h.null_id = GDDD::null.concret;
+  h.one_id = GDDD::one.concret;
+  h.top_id = GDDD::top.concret;
+  h.nb_nodes = nb_nodes;
+  h.nb_roots = list.size();
+  h.nb_slots = nb_slots;
+  h.roots_pos = align8(sizeof(h));
+  h.offsets_pos = align8(h.roots_pos + list.size() * sizeof(GDDD::id_t));
+  h.nodes_pos = h.offsets_pos + nb_nodes * sizeof(uint64_t);
+  uint64_t pos = h.nodes_pos;
+  for (size_t i = 3; i < nodes.size(); ++i) {
+    offsets[i - 3] = pos;
+    pos += align8(_GDDD::node_size(nodes[i].nbruns()));
+  }
+  h.slots_pos = pos;
+  h.file_size = pos + nb_slots * sizeof(GDDD::id_t);
+
+  os.write(reinterpret_cast<const char *> (&h), sizeof(h));
+  write_zeros(os, h.roots_pos - sizeof(h));
+  std::vector<GDDD::id_t> roots (list.size());
+  for (size_t i = 0; i < list.size(); ++i)
+    roots[i] = ids[numbering.index(list[i])];
+  os.write(reinterpret_cast<const char *> (roots.data()), roots.size() * sizeof(GDDD::id_t));
+  write_zeros(os, h.offsets_pos - h.roots_pos - roots.size() * sizeof(GDDD::id_t));
+  os.write(reinterpret_cast<const char *> (offsets.data()), offsets.size() * sizeof(uint64_t));
+
+  // the images are built in a buffer, with the sons renumbered ; their hash codes then
+  // depend only on the snapshot, not on the ids of the table
+  std::vector<uint64_t> buffer;
+  std::vector<GDDD::run_t> runs;
+  for (size_t i = 3; i < nodes.size(); ++i) {
+    const GDDD & d = nodes[i];
+    runs.clear();
+    for (GDDD::const_run_iterator vi = d.runs_begin(); vi != d.runs_end(); ++vi) {
+      runs.push_back(GDDD::run_t (vi->lo, vi->hi, GDDD(ids[numbering.index(vi->son)])));
+    }
+    size_t size = align8(_GDDD::node_size(runs.size()));
+    buffer.assign(size / 8, 0);
+    const _GDDD * image = _GDDD::build_image(reinterpret_cast<char *> (buffer.data()), d.variable(), runs);
+    size_t slot = image->hash() & (nb_slots - 1);
+    while (slots[slot] != 0)
+      slot = (slot + 1) & (nb_slots - 1);
+    slots[slot] = ids[i];
+    os.write(reinterpret_cast<const char *> (buffer.data()), size);
+  }
+  os.write(reinterpret_cast<const char *> (slots.data()), nb_slots * sizeof(GDDD::id_t));
+  if (! os)
+    throw std::runtime_error("saveDDDSnapshot : write error");
+}
+
+void mapDDDSnapshot(const std::string& path, std::vector<DDD>& list) {
+  if (frozen_region::mapped())
+    throw std::runtime_error("mapDDDSnapshot : a snapshot is already mapped");
+
+  const char * base = NULL;
+  size_t size = 0;
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("mapDDDSnapshot : cannot open " + path);
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(snapshot_header)) {
+    close(fd);
+    throw std::runtime_error("mapDDDSnapshot : not a DDD snapshot " + path);
+  }
+  size = st.st_size;
+  void * addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("mapDDDSnapshot : cannot map " + path);
+  base = static_cast<const char *> (addr);
+#else
+  // no mapping : the file is read in a buffer that lives as long as the process
+  std::ifstream in (path.c_str(), std::ios::binary);
+  if (! in)
+    throw std::runtime_error("mapDDDSnapshot : cannot open " + path);
+  in.seekg(0, std::ios::end);
+  size = in.tellg();
+  in.seekg(0, std::ios::beg);
+  if (size < sizeof(snapshot_header))
+    throw std::runtime_error("mapDDDSnapshot : not a DDD snapshot " + path);
+  uint64_t * buffer = new uint64_t [align8(size) / 8];
+  in.read(reinterpret_cast<char *> (buffer), size);
+  base = reinterpret_cast<const char *> (buffer);
+#endif
+
+  const snapshot_header & h = * reinterpret_cast<const snapshot_header *> (base);
+  const char * error = NULL;
+  if (std::memcmp(h.magic, snapshot_magic, sizeof(h.magic)) != 0)
+    error = "mapDDDSnapshot : not a DDD snapshot";
+  else if (h.version != snapshot_version)
+    error = "mapDDDSnapshot : unsupported version";
+  else if (h.soa_arcs != snapshot_soa_arcs || h.sizeof_val != sizeof(GDDD::val_t)
+           || h.sizeof_id != sizeof(GDDD::id_t) || h.sizeof_node != sizeof(_GDDD)
+           || h.null_id != GDDD::null.concret || h.one_id != GDDD::one.concret
+           || h.top_id != GDDD::top.concret)
+    error = "mapDDDSnapshot : snapshot saved by an incompatible build of the library";
+  else if (h.file_size != size || h.nb_nodes >= GDDD::frozen_bit
+           || h.nb_slots == 0 || (h.nb_slots & (h.nb_slots - 1)) != 0 || h.nb_slots <= h.nb_nodes
+           || h.roots_pos < sizeof(h) || h.roots_pos + h.nb_roots * sizeof(GDDD::id_t) > h.offsets_pos
+           || h.offsets_pos + h.nb_nodes * sizeof(uint64_t) != h.nodes_pos
+           || h.nodes_pos > h.slots_pos || h.slots_pos + h.nb_slots * sizeof(GDDD::id_t) != size
+           || (h.roots_pos | h.offsets_pos | h.slots_pos) & 7)
+    error = "mapDDDSnapshot : corrupt snapshot";
+
+  // the sections are checked before any id is resolved : the file is not trusted.
+  // Nodes lie between nodes_pos and slots_pos, with sorted runs whose sons are terminals or
+  // nodes saved before them, so that there is no cycle ; roots and slots designate terminals
+  // or nodes, and empty slots are 0.
+  if (error == NULL) {
+    const uint64_t * offsets = reinterpret_cast<const uint64_t *> (base + h.offsets_pos);
+    for (size_t k = 0; k < h.nb_nodes && error == NULL; ++k) {
+      const uint64_t offset = offsets[k];
+      if (offset < h.nodes_pos || (offset & 7) || offset + sizeof(_GDDD) > h.slots_pos) {
+        error = "mapDDDSnapshot : corrupt snapshot";
+        break;
+      }
+      const _GDDD * node = reinterpret_cast<const _GDDD *> (base + offset);
+      if (node->valuation_size == 0 || offset + _GDDD::node_size(node->valuation_size) > h.slots_pos) {
+        error = "mapDDDSnapshot : corrupt snapshot";
+        break;
+      }
+      GDDD::wide_val_t previous = 0;
+      for (_GDDD::const_iterator it = node->begin(); it != node->end(); ++it) {
+        const GDDD::id_t son = it->son.concret;
+        const bool terminal = son == h.null_id || son == h.one_id || son == h.top_id;
+        if ((! terminal && (! frozen_region::is_frozen(son) || (son & ~GDDD::frozen_bit) >= k))
+            || it->lo > it->hi || (it != node->begin() && GDDD::wide_val_t (it->lo) <= previous)) {
+          error = "mapDDDSnapshot : corrupt snapshot";
+          break;
+        }
+        previous = it->hi;
+      }
+    }
+    const GDDD::id_t * roots = reinterpret_cast<const GDDD::id_t *> (base + h.roots_pos);
+    for (size_t i = 0; i < h.nb_roots && error == NULL; ++i) {
+      const GDDD::id_t id = roots[i];
+      if (id != h.null_id && id != h.one_id && id != h.top_id
+          && (! frozen_region::is_frozen(id) || (id & ~GDDD::frozen_bit) >= h.nb_nodes))
+        error = "mapDDDSnapshot : corrupt snapshot";
+    }
+    const GDDD::id_t * slots = reinterpret_cast<const GDDD::id_t *> (base + h.slots_pos);
+    for (size_t i = 0; i < h.nb_slots && error == NULL; ++i) {
+      const GDDD::id_t id = slots[i];
+      if (id != 0 && (! frozen_region::is_frozen(id) || (id & ~GDDD::frozen_bit) >= h.nb_nodes))
+        error = "mapDDDSnapshot : corrupt snapshot";
+    }
+  }
+
+  if (error != NULL) {
+#ifndef _WIN32
+    munmap(const_cast<char *> (base), size);
+#else
+    delete [] reinterpret_cast<const uint64_t *> (base);
+#endif
+    throw std::runtime_error(error);
+  }
+
+  frozen_region::base_ = base;
+  frozen_region::offsets_ = reinterpret_cast<const uint64_t *> (base + h.offsets_pos);
+  frozen_region::slots_ = reinterpret_cast<const GDDD::id_t *> (base + h.slots_pos);
+  frozen_region::mask_ = h.nb_slots - 1;
+
+  // a node both in the table and in the snapshot would have two ids
+  const DDDutable & table = DDDutable::instance();
+  for (DDDutable::table_it it = table.begin(); it != table.end(); ++it) {
+    if (frozen_region::find(*table.resolve(*it)) != 0) {
+      frozen_region::base_ = NULL;
+      frozen_region::offsets_ = NULL;
+      frozen_region::slots_ = NULL;
+      frozen_region::mask_ = 0;
+#ifndef _WIN32
+      munmap(const_cast<char *> (base), size);
+#else
+      delete [] reinterpret_cast<const uint64_t *> (base);
+#endif
+      throw std::runtime_error("mapDDDSnapshot : the snapshot shares nodes with the unicity table");
+    }
+  }
+
+  const GDDD::id_t * roots = reinterpret_cast<const GDDD::id_t *> (base + h.roots_pos);
+  list.resize(h.nb_roots);
+  for (size_t i = 0; i < h.nb_roots; ++i)
+    list[i] = GDDD(roots[i]);
+}
+
 #include "MemoryManager.h"
 
 // for lack of a better place to put it...
@@ -24,8 +24,12 @@
 #ifndef DDD_H
 #define DDD_H
 
+#include <cstddef>
 #include <iosfwd>
+#include <iterator>
+#include <new>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ddd/DataSet.h"
@@ -48,13 +52,25 @@ class DDD;
 class GDDD 
 {
 public:
+  /// The identifier of a node in the unicity table.
+  /// Configure with --enable-large-ids (DDD_LARGE_IDS) to allow more than 2^32 nodes, at the
+  /// price of twice the memory for the sons of nodes, the reference counts and the computed table.
+#ifdef DDD_LARGE_IDS
+  typedef uint64_t id_t;
+#else
   typedef unsigned int id_t;
+#endif
+  /// Ids with this bit set designate the read only nodes of a mapped snapshot, see mapDDDSnapshot.
+  /// They are not in the unicity table, so that they are neither reference counted nor collected.
+  static const id_t frozen_bit = id_t(1) << (8 * sizeof(id_t) - 1);
 private:
   /// A textual output. 
   /// Don't use it with large number of paths as each element is printed on a different line
   friend std::ostream& operator<<(std::ostream &os,const GDDD &g);
   /// Open access to concret for reference counting in DDD.
   friend class DDD;
+  /// Open access to concret for the computed table of operations.
+  friend class DED;
 
   /// The real implementation class. All true operations are delagated on this pointer.
   /// Construction/destruction take care of ensuring concret is only instantiated once in memory.
@@ -67,22 +83,49 @@ private:
   GDDD(_GDDD *_g);
   /// Internal function used in recursion for textual printing of GDDD.
   void print(std::ostream& os,std::string s) const;
-  /// A function for DDD serialization (beta).
-  void saveNode(std::ostream&, std::vector<id_t>& )const;
-  /// Another function used in serialization.
-  unsigned long int nodeIndex(const std::vector<id_t> &)const;
 
 public:
   /// \name Public Accessors 
   //@{
+  /// The values labeling arcs. Configure with --with-val-bits=8|16|32 (DDD_VAL_BITS) to pick
+  /// 8 bit values for compact boolean models, or 32 bit values for counters. Default is 16 bits.
+  /// Operations on runs cost the same whatever their width, except StrongHom::eval, which calls
+  /// phi once per value : keep runs narrow under user strong homomorphisms of 32 bit models.
+#if DDD_VAL_BITS == 8
+  typedef int8_t val_t;
+#elif DDD_VAL_BITS == 32
+  typedef int32_t val_t;
+#else
   typedef short val_t;
+#endif
+  /// A type that holds any val_t, plus one and minus one : bounds computed while sweeping runs.
+#if DDD_VAL_BITS == 32
+  typedef int64_t wide_val_t;
+#else
+  typedef int wide_val_t;
+#endif
   /// An edge is a pair <value,child node>
   typedef std::pair<val_t,GDDD> edge_t;
   /// To hide how arcs are actually stored. Use GDDD::Valuation to refer to arcs type
   typedef std::vector<edge_t > Valuation;
+  /// Nodes store their arcs as runs : all values of an interval [lo,hi] lead to the same son.
+  /// Runs of a node are maximal (two consecutive runs are not contiguous or have distinct sons)
+  /// and sorted, so that the representation remains canonical.
+  struct run_t;
   /// To hide how arcs are stored. Also for more compact expressions : 
-  /// use GDDD::const_iterator to iterate over the arcs of a DDD
-  typedef const edge_t * const_iterator;
+  /// use GDDD::const_iterator to iterate over the arcs of a DDD, one value at a time
+  class const_iterator;
+  /// To iterate over the runs of a node, see runs_begin()
+  /// By default a node stores an array of run_t. Built with DDD_SOA_ARCS (configure --enable-soa-arcs),
+  /// it stores the array of the lower bounds of its runs, then the array of their upper bounds, then
+  /// the array of their sons : searches by value then scan contiguous values.
+#ifdef DDD_SOA_ARCS
+  class const_run_iterator;
+#else
+  typedef const run_t * const_run_iterator;
+#endif
+  /// To enumerate the paths of a DDD lazily, see paths_begin()
+  class path_iterator;
   /// Returns a node's variable.
   int variable() const;
 
@@ -100,6 +143,31 @@ public:
   ///
   /// returns a past the end iterator
   const_iterator end() const;
+
+  /// API for iterating over the runs of arcs of a node, an arc per run instead of an arc per value.
+  /// Operations that treat all the values of a run alike should prefer this.
+  ///
+  /// for (GDDD::const_run_iterator it = d.runs_begin() ; it != d.runs_end() ; ++it ) { // arcs it->lo..it->hi to it->son }
+  ///
+  /// returns the first run
+  const_run_iterator runs_begin() const;
+  /// returns a past the end run iterator
+  const_run_iterator runs_end() const;
+  /// Returns the run holding the arcs labeled val, or runs_end() if there is none.
+  const_run_iterator find(val_t val) const;
+  /// Returns the first run of [first,last) whose values are not all lower than val, or last.
+  /// The runs should be those of a single node, see find.
+  static const_run_iterator seek(const_run_iterator first, const_run_iterator last, wide_val_t val);
+
+  /// API for enumerating the paths of a DDD leading to one, that is the states of the set,
+  /// without building them all. Paths are visited in increasing lexicographic order.
+  ///
+  /// for (GDDD::path_iterator it = d.paths_begin() ; it != d.paths_end() ; ++it ) { // values (*it)[0..it->size()) }
+  ///
+  /// returns an iterator on the first path
+  path_iterator paths_begin() const;
+  /// returns a past the end path iterator
+  path_iterator paths_end() const;
   //@}
 
   /// \name Public Constructors 
@@ -123,6 +191,7 @@ public:
   /// To create a DDD with arcs covering a range of values.
   /// This interface creates nodes with a set of arcs bearing the values in the interval 
   /// [val1,var2] that point to the same successor node d.
+  /// The node holds a single run, whatever the width of the interval.
   /// \param var the variable labeling the node
   /// \param val1 lowest value labeling an arc
   /// \param val2 highest value labeling an arc
@@ -130,6 +199,58 @@ public:
   GDDD(int var,val_t val1,val_t val2,const GDDD &d=one); //var-[val1,var2]->d
   //@}
 
+  /// Builds a node arc by arc, without an intermediate Valuation.
+  /// Arcs are stored directly after the node header, in a buffer of the calling thread that
+  /// is reused across builders, so that finalize() only copies the node once, into the unicity table.
+  ///
+  /// GDDD::Builder b(var);
+  /// for ( ... ) b.add(val, son); // in increasing order of val, son != null
+  /// return b.finalize();
+  ///
+  /// Arcs are gathered into maximal runs as they are added.
+  /// Builders nest : the sons of a node may be built while building it.
+  /// A builder must be used by the thread that created it.
+  class Builder {
+    int variable_;
+    /// the buffer : room for the node header followed by capacity_ runs
+    char * buffer_;
+#ifdef DDD_SOA_ARCS
+    /// the three arrays of the runs, each sized for capacity_ runs
+    val_t * lo_;
+    val_t * hi_;
+    GDDD * sons_;
+#else
+    run_t * runs_;
+#endif
+    size_t size_;
+    size_t capacity_;
+    /// double the capacity of the buffer, throws std::length_error beyond 2^32 - 1 runs
+    void grow ();
+    /// set the array pointers for the buffer and capacity
+    void layout ();
+    /// destroy the runs added
+    void clear ();
+    /// append a run that does not extend the last one
+    inline void push (val_t lo, val_t hi, const GDDD & son);
+    /// the id of the node built, even without arcs (terminals)
+    id_t unique ();
+    friend class _GDDD;
+    Builder (const Builder &);
+    Builder & operator= (const Builder &);
+  public:
+    explicit Builder (int variable);
+    ~Builder ();
+    /// Append an arc, values must be added in increasing order.
+    inline void add (val_t val, const GDDD & son);
+    /// Append the arcs of values lo..hi to son, lo must be greater than the values already added.
+    inline void add (val_t lo, val_t hi, const GDDD & son);
+    /// Number of runs added so far.
+    size_t size () const { return size_; }
+    bool empty () const { return size_ == 0; }
+    /// Returns the unique node built, or null if no arc was added. The builder is then empty.
+    GDDD finalize ();
+  };
+
 
   /// \name Terminal nodes defined as constants 
   //@{
@@ -167,8 +288,10 @@ public:
   unsigned int refCounter() const;
   /// Returns the size in number of nodes of a DDD structure.
   unsigned long int size() const;
-  /// Returns the number of successors of a given node. This is the size of the arc array of the node.
+  /// Returns the number of successors of a given node, that is the number of values labeling its arcs.
   size_t nbsons () const;
+  /// Returns the number of runs of arcs of a given node. This is the size of the arc array of the node.
+  size_t nbruns () const;
   /// Returns the number of states or paths represented by a given node.
   long double nbStates() const;
   /// Returns the number of nodes that would be used to represent a DDD if no unicity table was used.
@@ -197,34 +320,321 @@ public:
   /// \name Memory Management 
   //@{
   /// Returns unicity table current size. Gives the number of different nodes created and not yet destroyed.
-  static  unsigned int statistics();
+  static  size_t statistics();
   /// For garbage collection internals. Marks a GDDD as in use in garbage collection phase. 
   /// 
   void mark() const;
   /// For storage in a hash table
   size_t hash () const { 
-    return ddd::int32_hash(concret); 
+    return ddd::id_hash(concret); 
   }
   /// For garbage collection, do not call this directly, use MemoryManager::garbage() instead.
   /// \todo describe garbage collection algorithm(s) + mark usage homogeneously in one place.
   static void garbage(); 
+  /// The two phases of garbage(), MemoryManager::garbage() sweeps operation caches in between.
+  static void garbage_mark();
+  static void garbage_sweep();
+  /// For garbage collection internals. Between garbage_mark() and garbage_sweep(), whether this node survives.
+  bool is_marked() const;
   /// Prints some statistics to std::cout. Mostly used in debug and development phase.
   /// See also MemoryManager::pstats().
   /// \todo allow output in other place than cout. Clean up output.
   static void pstats(bool reinit=true);
   /// Returns the peak size of the DDD unicity table. This value is maintained up to date upon GarbageCollection.
   static size_t peak();
+  /// Returns the number of updates of reference counts made by DDD since the last pstats(true).
+  /// Reference counts are a dense array indexed by id : each update is a single access, and
+  /// a node referenced while not in the roots of the collection is also pushed to them.
+  static size_t refUpdates();
+  /// Sets the policy of the generational garbage collection of DDD nodes.
+  /// Nodes that survive promotion_age collections are only collected by major collections,
+  /// that occur at least every major_period collections. promotion_age=0 makes all collections major.
+  /// Defaults are promotion_age=2, major_period=8.
+  static void setGCPolicy(unsigned int promotion_age, unsigned int major_period);
+  /// Sets the number of threads used to mark and sweep DDD nodes, default is 1.
+  /// Only effective in builds with parallel mode turned on (PARALLEL_DD).
+  static void setGCThreads(unsigned int nb_threads);
   //@}
   /// \name Serialization functions.
   //@{
   /// Function for serialization. Save a set of DDD to a stream.
   friend void saveDDD(std::ostream&, std::vector<DDD>);
   /// Function for deserialization. Load a set of DDD from a stream.
+  /// list should have the size of the saved list.
   friend void loadDDD(std::istream&, std::vector<DDD>&);
+  /// Save a set of DDD to a stream in a compact binary format : a header, then the nodes
+  /// (sons first) as varints, then the indexes of the DDD of list.
+  /// Time and memory are linear in the number of nodes.
+  friend void saveDDDBinary(std::ostream&, const std::vector<DDD>&);
+  /// Load a set of DDD saved by saveDDDBinary, list is resized to the number of DDD saved.
+  /// Throws std::runtime_error if the stream is truncated or is not in this format.
+  friend void loadDDDBinary(std::istream&, std::vector<DDD>&);
+  /// Save a set of DDD as a snapshot, that mapDDDSnapshot maps in memory as is.
+  /// The nodes are stored in the layout of this build of the library.
+  friend void saveDDDSnapshot(std::ostream&, const std::vector<DDD>&);
+  /// Map a snapshot file read only, and set list to the DDD saved in it.
+  /// The nodes of the snapshot are used in place, without rehashing or allocation : the file
+  /// is only read once to check its sections. New nodes still go to the unicity table.
+  /// At most one snapshot is mapped, for the life of the process. The snapshot should be mapped
+  /// before concurrent operations start, and should not share nodes with the unicity table.
+  /// Throws std::runtime_error if the file cannot be mapped, was saved by an incompatible build,
+  /// is corrupt (offsets out of the nodes section, ids of roots, sons or slots designating
+  /// no node), or shares nodes with the table.
+  friend void mapDDDSnapshot(const std::string&, std::vector<DDD>&);
   //@}
 };
 
 
+/// A run of arcs of a node : the values lo..hi all lead to son.
+struct GDDD::run_t {
+  val_t lo;
+  val_t hi;
+  GDDD son;
+
+  run_t (val_t l, val_t h, const GDDD & s) : lo(l), hi(h), son(s) {}
+  /// number of arcs of the run
+  size_t size () const { return size_t (wide_val_t (hi) - lo) + 1; }
+  bool operator== (const run_t & r) const { return lo == r.lo && hi == r.hi && son == r.son; }
+  bool operator!= (const run_t & r) const { return ! (*this == r); }
+  bool operator< (const run_t & r) const {
+    if (lo != r.lo) return lo < r.lo;
+    if (hi != r.hi) return hi < r.hi;
+    return son < r.son;
+  }
+};
+
+#ifdef DDD_SOA_ARCS
+/// Iterates over the runs of a node stored as arrays : a random access iterator that gathers
+/// the fields of the current run on access.
+class GDDD::const_run_iterator {
+  const val_t * lo_;
+  const val_t * hi_;
+  const GDDD * son_;
+  mutable run_t run_;
+public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef run_t value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const run_t * pointer;
+  typedef const run_t & reference;
+
+  const_run_iterator () : lo_(NULL), hi_(NULL), son_(NULL), run_(0, 0, GDDD()) {}
+  const_run_iterator (const val_t * lo, const val_t * hi, const GDDD * son)
+    : lo_(lo), hi_(hi), son_(son), run_(0, 0, GDDD()) {}
+
+  /// the arrays of the node, from the current run on
+  const val_t * lo_ptr () const { return lo_; }
+  const val_t * hi_ptr () const { return hi_; }
+  const GDDD * son_ptr () const { return son_; }
+
+  /// the run is copied into the iterator : the reference is only valid until the next access
+  reference operator* () const {
+    run_.lo = *lo_;
+    run_.hi = *hi_;
+    run_.son = *son_;
+    return run_;
+  }
+  pointer operator-> () const { return &**this; }
+
+  const_run_iterator & operator++ () { ++lo_; ++hi_; ++son_; return *this; }
+  const_run_iterator operator++ (int) { const_run_iterator tmp = *this; ++*this; return tmp; }
+  const_run_iterator & operator-- () { --lo_; --hi_; --son_; return *this; }
+  const_run_iterator operator-- (int) { const_run_iterator tmp = *this; --*this; return tmp; }
+  const_run_iterator & operator+= (difference_type n) { lo_ += n; hi_ += n; son_ += n; return *this; }
+  const_run_iterator & operator-= (difference_type n) { return *this += -n; }
+  const_run_iterator operator+ (difference_type n) const { const_run_iterator tmp = *this; return tmp += n; }
+  const_run_iterator operator- (difference_type n) const { const_run_iterator tmp = *this; return tmp += -n; }
+  difference_type operator- (const const_run_iterator & o) const { return lo_ - o.lo_; }
+  run_t operator[] (difference_type n) const { return run_t(lo_[n], hi_[n], son_[n]); }
+
+  bool operator== (const const_run_iterator & o) const { return lo_ == o.lo_; }
+  bool operator!= (const const_run_iterator & o) const { return lo_ != o.lo_; }
+  bool operator< (const const_run_iterator & o) const { return lo_ < o.lo_; }
+};
+#endif
+
+/// Iterates over the arcs of a node one value at a time, expanding its runs.
+/// Dereferencing gives an edge_t, valid until the iterator is incremented.
+class GDDD::const_iterator {
+  const_run_iterator run_;
+  const_run_iterator end_;
+  edge_t edge_;
+public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef edge_t value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const edge_t * pointer;
+  typedef const edge_t & reference;
+
+  const_iterator () : run_(), end_(), edge_(0, GDDD()) {}
+  /// positioned on the first value of run r, or past the end if r == end
+  const_iterator (const_run_iterator r, const_run_iterator end)
+    : run_(r), end_(end), edge_(r != end ? r->lo : 0, r != end ? r->son : GDDD()) {}
+
+  reference operator* () const { return edge_; }
+  pointer operator-> () const { return &edge_; }
+  /// the run holding the current arc
+  const_run_iterator run () const { return run_; }
+
+  const_iterator & operator++ () {
+    if (edge_.first < run_->hi) {
+      ++edge_.first;
+    } else if (++run_ != end_) {
+      edge_.first = run_->lo;
+      edge_.second = run_->son;
+    } else {
+      edge_.first = 0;
+    }
+    return *this;
+  }
+  const_iterator operator++ (int) { const_iterator tmp = *this; ++*this; return tmp; }
+  bool operator== (const const_iterator & o) const { return run_ == o.run_ && edge_.first == o.edge_.first; }
+  bool operator!= (const const_iterator & o) const { return ! (*this == o); }
+};
+
+/// Enumerates the paths of a DDD to one, depth first with an explicit stack of the runs taken.
+/// Dereferencing gives the values of the current path, in a buffer reused from a path to the
+/// next : stepping to the next path does not allocate once the buffers reach the depth of the DDD.
+/// Paths leading to top are not states, and are not enumerated.
+class GDDD::path_iterator {
+  /// the run taken at a depth of the path, and the value taken in it
+  struct frame {
+    const_run_iterator run;
+    const_run_iterator end;
+    wide_val_t val;
+    wide_val_t hi;
+    GDDD son;
+    int variable;
+    bool operator== (const frame & f) const { return run == f.run && val == f.val; }
+  };
+  std::vector<frame> stack_;
+  std::vector<val_t> values_;
+  bool end_;
+
+  /// follow the first runs from g, returns true if they lead to one
+  bool descend (GDDD g) {
+    while (g != one) {
+      if (g == null || g == top)
+        return false;
+      frame f;
+      f.run = g.runs_begin();
+      f.end = g.runs_end();
+      f.val = f.run->lo;
+      f.hi = f.run->hi;
+      f.son = f.run->son;
+      f.variable = g.variable();
+      stack_.push_back(f);
+      values_.push_back(f.val);
+      g = f.son;
+    }
+    return true;
+  }
+
+  /// backtrack to the deepest run with an untried value, and descend from it
+  void advance () {
+    while (! stack_.empty()) {
+      frame & f = stack_.back();
+      if (f.val < f.hi) {
+        values_.back() = ++f.val;
+      } else if (++f.run != f.end) {
+        f.val = f.run->lo;
+        f.hi = f.run->hi;
+        f.son = f.run->son;
+        values_.back() = f.val;
+      } else {
+        stack_.pop_back();
+        values_.pop_back();
+        continue;
+      }
+      if (descend(f.son))
+        return;
+    }
+    end_ = true;
+  }
+
+public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef std::vector<val_t> value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const value_type * pointer;
+  typedef const value_type & reference;
+
+  /// a past the end iterator
+  path_iterator () : end_(true) {}
+  /// positioned on the first path of g
+  explicit path_iterator (const GDDD & g) : end_(false) {
+    if (! descend(g))
+      advance();
+  }
+
+  /// the values of the current path, valid until the iterator moves
+  reference operator* () const { return values_; }
+  pointer operator-> () const { return &values_; }
+  /// the variable of the node at depth of the current path
+  int variable (size_t depth) const { return stack_[depth].variable; }
+
+  path_iterator & operator++ () { advance(); return *this; }
+  path_iterator operator++ (int) { path_iterator tmp = *this; advance(); return tmp; }
+
+  /// Skips the paths that share the values of the current path up to depth included : the
+  /// next path differs from the current one at depth or above. depth should be lower than the
+  /// length of the current path.
+  void skip (size_t depth) {
+    stack_.erase(stack_.begin() + depth + 1, stack_.end());
+    values_.resize(depth + 1);
+    advance();
+  }
+
+  bool operator== (const path_iterator & o) const {
+    return end_ == o.end_ && (end_ || stack_ == o.stack_);
+  }
+  bool operator!= (const path_iterator & o) const { return ! (*this == o); }
+};
+
+inline GDDD::path_iterator GDDD::paths_begin () const {
+  return path_iterator(*this);
+}
+
+inline GDDD::path_iterator GDDD::paths_end () const {
+  return path_iterator();
+}
+
+#ifdef DDD_SOA_ARCS
+inline void GDDD::Builder::push (val_t lo, val_t hi, const GDDD & son) {
+  if (size_ == capacity_)
+    grow();
+  lo_[size_] = lo;
+  hi_[size_] = hi;
+  new (sons_ + size_) GDDD(son);
+  ++size_;
+}
+
+inline void GDDD::Builder::add (val_t lo, val_t hi, const GDDD & son) {
+  if (size_ != 0 && sons_[size_-1] == son && wide_val_t (hi_[size_-1]) + 1 == lo)
+    hi_[size_-1] = hi;
+  else
+    push(lo, hi, son);
+}
+#else
+inline void GDDD::Builder::push (val_t lo, val_t hi, const GDDD & son) {
+  if (size_ == capacity_)
+    grow();
+  new (runs_ + size_) run_t(lo, hi, son);
+  ++size_;
+}
+
+inline void GDDD::Builder::add (val_t lo, val_t hi, const GDDD & son) {
+  if (size_ != 0 && runs_[size_-1].son == son && wide_val_t (runs_[size_-1].hi) + 1 == lo)
+    runs_[size_-1].hi = hi;
+  else
+    push(lo, hi, son);
+}
+#endif
+
+inline void GDDD::Builder::add (val_t val, const GDDD & son) {
+  add(val, val, son);
+}
+
 /// Textual output of DDD into a stream in (relatively) human readable format.
 std::ostream& operator<<(std::ostream &,const GDDD &);
 /* Binary operators */
@@ -250,11 +660,24 @@ GDDD operator-(const GDDD&,const GDDD&);
 /// are still in use upon garbage collection.
 class DDD : public GDDD, public DataSet 
 {
+  /// Terminals are never collected (see GDDD::garbage_mark), so references to them are not
+  /// counted : default constructed and moved-from DDD do not touch the reference table.
+  /// Neither are references to the nodes of a mapped snapshot.
+  static bool counted (id_t id) {
+    return id != null.concret && id != one.concret && id != top.concret && ! (id & frozen_bit);
+  }
+  /// Reference counting of concret, in the unicity table.
+  static void ref (id_t id);
+  static void deref (id_t id);
 public:
   /* Constructors */
   /// Copy constructor. Constructs a copy, actual data (concret) is not copied.
   /// RefCounter is updated however.
   DDD(const DDD &);
+  /// Move constructor, takes over the reference of g which is left equal to GDDD::null.
+  DDD(DDD && g) noexcept : GDDD(g.concret), DataSet() {
+    g.concret = null.concret;
+  }
   /// Copy constructor from base class GDDD, also default DDD constructor to empty set. 
   /// Increments refCounter of g.concret.
   DDD(const GDDD &g=GDDD::null);
@@ -287,6 +710,11 @@ public:
   DDD &operator=(const GDDD&);
   /// Overloaded behavior for assignment operator, maintains reference counting.
   DDD &operator=(const DDD&);
+  /// Move assignment, exchanges the references held by the two DDD.
+  DDD &operator=(DDD && g) noexcept {
+    std::swap(concret, g.concret);
+    return *this;
+  }
   //@}
 
   /// \name DataSet implementation interface 
@@ -22,32 +22,58 @@
 
 
 /* -*- C++ -*- */
+#include <algorithm>
 #include <set>
 #include <iostream>
 #include <map>
+#include <limits>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include <typeinfo>
 // ajout
 
 #include "ddd/util/configuration.hh"
 #include "ddd/util/set.hh"
+#include "ddd/CacheBudget.hh"
 #include "ddd/DDD.h"
 #include "ddd/DED.h"
 #include "ddd/Hom.h"
 
 #ifdef REENTRANT
-#include "tbb/atomic.h"
+#include <atomic>
+#include "tbb/spin_mutex.h"
 #endif
 /******************************************************************************/
 
-typedef hash_map< DED, GDDD>::type Cache;
+typedef hash_map< DED, Stamped<GDDD> >::type Cache;
 
 static Cache cache;
 
+/// bounds the cache by the cache budget, an entry also owns the operation its key points to
+class DEDCacheBudget : public BudgetedCache {
+  /// frees the key of an evicted entry
+  struct release_key {
+    void operator() (const std::pair<const DED, Stamped<GDDD> > & e) const {
+      delete e.first.concret;
+    }
+  };
+public:
+  DEDCacheBudget () : BudgetedCache ("DED cache", sizeof(std::pair<const DED, Stamped<GDDD> >) + 6 * sizeof(void *)) {}
+  size_t size () const { return cache.size(); }
+  size_t evict (size_t target) {
+    DED::peak();
+    return CacheBudget::evict(cache, policy(), target, release_key());
+  }
+};
+
+static DEDCacheBudget cache_budget;
+
 #ifdef REENTRANT
 
-static tbb::atomic<int> Hits;
-static tbb::atomic<int> Misses;
+static std::atomic<int> Hits;
+static std::atomic<int> Misses;
 class DED_parallel_init
 {
 public:
@@ -67,6 +93,219 @@ static int Misses=0;
 
 #endif
 
+/******************************************************************************/
+/*                    computed table of binary operations                     */
+/******************************************************************************/
+/// The cache of the binary operations +, *, - and ^ on GDDD.
+/// A direct mapped array of POD entries keyed by the operation and the ids of the operands :
+/// lookups allocate nothing, and a new entry overwrites the one it collides with, so memory
+/// is bounded. The array doubles when half full, up to max_size_ entries, and halves when the
+/// cache budget requires it.
+/// Garbage collection only drops the entries that refer to a dead node, see sweep.
+/// In REENTRANT builds the array is allocated at its maximal size (calloc only backs the pages
+/// that are touched) and entries are protected by striped spin locks.
+class computed_table {
+public:
+  typedef GDDD::id_t id_t;
+private:
+  struct entry {
+    /// the binary_op, 0 for a free entry
+    uint32_t op;
+    id_t a;
+    id_t b;
+    id_t res;
+  };
+
+  entry * entries_;
+  /// a power of two
+  size_t size_;
+  size_t max_size_;
+#ifdef REENTRANT
+  static const size_t nb_locks = 256;
+  tbb::spin_mutex locks_[nb_locks];
+  std::atomic<size_t> used_;
+  std::atomic<size_t> hits_;
+  std::atomic<size_t> misses_;
+#else
+  size_t used_;
+  size_t hits_;
+  size_t misses_;
+#endif
+
+  static size_t round_up (size_t s) {
+    size_t c = 16;
+    while (c < s) {
+      c *= 2;
+    }
+    return c;
+  }
+
+  static entry * allocate (size_t n) {
+    entry * e = (entry *) calloc (n, sizeof(entry));
+    if (e == NULL) {
+      throw std::bad_alloc();
+    }
+    return e;
+  }
+
+  size_t index (unsigned int op, id_t a, id_t b) const {
+    return ddd::wang32_hash (ddd::id_hash (a ^ (id_t (op) << 29)) ^ ddd::id_hash (b)) & (size_ - 1);
+  }
+
+  /// reallocate the array with new_size entries, keeping the entries that still fit
+  void resize (size_t new_size) {
+    entry * old = entries_;
+    size_t old_size = size_;
+    size_ = new_size;
+    entries_ = allocate (size_);
+    used_ = 0;
+    for (size_t i = 0; i < old_size; ++i) {
+      const entry & e = old[i];
+      if (e.op != 0) {
+        entry & ne = entries_[index (e.op, e.a, e.b)];
+        if (ne.op == 0) {
+          ++used_;
+        }
+        ne = e;
+      }
+    }
+    free (old);
+  }
+
+  computed_table (const computed_table &);
+  computed_table & operator= (const computed_table &);
+
+public:
+  computed_table () : max_size_ (1 << 22) {
+#ifdef REENTRANT
+    size_ = max_size_;
+#else
+    size_ = 1 << 12;
+#endif
+    entries_ = allocate (size_);
+    used_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+  ~computed_table () {
+    free (entries_);
+  }
+
+  /// look for the result of op(a,b)
+  bool find (unsigned int op, id_t a, id_t b, id_t & res) {
+    size_t i = index (op, a, b);
+#ifdef REENTRANT
+    tbb::spin_mutex::scoped_lock lock (locks_[i % nb_locks]);
+#endif
+    const entry & e = entries_[i];
+    if (e.op == op && e.a == a && e.b == b) {
+      res = e.res;
+      ++hits_;
+      return true;
+    }
+    ++misses_;
+    return false;
+  }
+
+  /// store res as the result of op(a,b), overwriting the colliding entry
+  void insert (unsigned int op, id_t a, id_t b, id_t res) {
+#ifndef REENTRANT
+    if (2 * (used_ + 1) > size_ && size_ < max_size_) {
+      resize (2 * size_);
+      // may shrink the array back
+      CacheBudget::inserted ((size_ / 2) * sizeof(entry));
+    }
+#endif
+    size_t i = index (op, a, b);
+#ifdef REENTRANT
+    tbb::spin_mutex::scoped_lock lock (locks_[i % nb_locks]);
+#endif
+    entry & e = entries_[i];
+    if (e.op == 0) {
+      ++used_;
+    }
+    e.op = op;
+    e.a = a;
+    e.b = b;
+    e.res = res;
+  }
+
+  /// Garbage collection : free the entries where is_marked does not hold for an operand or
+  /// the result. Returns the number of entries freed. Not thread safe.
+  template <typename Pred>
+  size_t sweep (const Pred & is_marked) {
+    size_t dropped = 0;
+    for (size_t i = 0; i < size_; ++i) {
+      entry & e = entries_[i];
+      if (e.op != 0 && ! (is_marked (e.a) && is_marked (e.b) && is_marked (e.res))) {
+        e.op = 0;
+        ++dropped;
+      }
+    }
+    used_ -= dropped;
+    return dropped;
+  }
+
+  /// bound the array to max entries, dropping the cached results if it is reallocated. Not thread safe.
+  void set_max_size (size_t max) {
+    max_size_ = round_up (max);
+#ifdef REENTRANT
+    bool realloc = size_ != max_size_;
+#else
+    bool realloc = size_ > max_size_;
+#endif
+    if (realloc) {
+      free (entries_);
+      size_ = max_size_;
+      entries_ = allocate (size_);
+      used_ = 0;
+    }
+  }
+
+  /// cache budget : halve the array until it has at most max entries. Not thread safe.
+  size_t shrink (size_t max) {
+    size_t new_size = size_;
+    while (new_size > 16 && new_size > max) {
+      new_size /= 2;
+    }
+    if (new_size == size_) {
+      return 0;
+    }
+    size_t before = used_;
+    resize (new_size);
+    return before - used_;
+  }
+
+  size_t size () const { return size_; }
+  size_t used () const { return used_; }
+  size_t bytes () const { return size_ * sizeof(entry); }
+  size_t hits () const { return hits_; }
+  size_t misses () const { return misses_; }
+  void reset_stats () {
+    hits_ = 0;
+    misses_ = 0;
+  }
+};
+
+static computed_table computed;
+
+/// bounds the computed table by the cache budget : its memory is the size of the array
+class ComputedTableBudget : public BudgetedCache {
+public:
+  ComputedTableBudget () : BudgetedCache ("DDD computed table", 4 * sizeof(GDDD::id_t)) {}
+  size_t size () const { return computed.used(); }
+  size_t bytes () const { return computed.bytes(); }
+  /// target is a number of slots of the array
+  size_t evict (size_t target) { return computed.shrink(target); }
+};
+
+static ComputedTableBudget computed_budget;
+
+// entries kept and dropped by garbage collections
+static size_t DEDkept = 0;
+static size_t DEDdropped = 0;
+
 /******************************************************************************/
 class _DED_GDDD:public _DED{
 private:
@@ -78,6 +317,7 @@ public:
     return (parameter==((_DED_GDDD*)&e)->parameter);
   };
   _DED * clone () const { return new _DED_GDDD(*this); }
+  bool is_marked() const { return parameter.is_marked(); }
   GDDD eval() const{return parameter;};
 };
 
@@ -87,13 +327,22 @@ public:
 class _DED_Add:public _DED{
 private:
   std::vector<GDDD> parameters;
-  _DED_Add(const std::set<GDDD> &d):parameters(d.begin(),d.end()){};
+  _DED_Add(const std::vector<GDDD> &d):parameters(d){};
 public:
   static  _DED *create(const std::set<GDDD> &d);
+  /// \param d sorted, without duplicates. Null is removed from it.
+  static  _DED *create(std::vector<GDDD> &d);
   /* Compare */
   size_t hash() const;
   bool operator==(const _DED &e)const;
   _DED * clone () const { return new _DED_Add(*this); }
+  bool is_marked() const {
+    for (std::vector<GDDD>::const_iterator it = parameters.begin() ; it != parameters.end() ; ++it) {
+      if (! it->is_marked())
+	return false;
+    }
+    return true;
+  }
   /* Transform */
   GDDD eval() const;
 
@@ -148,14 +397,76 @@ GHom pushEVDDD(int v){return new _pushEVDDD(v);};
 #endif
 
 
+/// Scratch buffers of the n-ary union, reused across calls.
+/// Evaluation recurses through add_sorted, so each level of the recursion leases its own.
+struct add_scratch {
+  /// a position in the runs of an operand
+  struct cursor {
+    GDDD::const_run_iterator it;
+    GDDD::const_run_iterator end;
+    /// for a min heap on the first value of the current run
+    bool operator< (const cursor & c) const { return it->lo > c.it->lo; }
+  };
+  /// the operands whose current run starts after the current value
+  std::vector<cursor> pending;
+  /// the operands whose current run holds the current value
+  std::vector<cursor> active;
+  /// the sons of the runs of the current values
+  std::vector<GDDD> sons;
+
+  /// the free buffers of the calling thread
+  static std::vector<add_scratch *> & pool () {
+#ifdef REENTRANT
+    static thread_local std::vector<add_scratch *> free;
+#else
+    static std::vector<add_scratch *> free;
+#endif
+    return free;
+  }
+
+  /// takes buffers from the pool for the lifetime of the lease
+  class lease {
+    add_scratch * s_;
+    lease (const lease &);
+    lease & operator= (const lease &);
+  public:
+    lease () {
+      std::vector<add_scratch *> & free = pool();
+      if (free.empty()) {
+        s_ = new add_scratch();
+      } else {
+        s_ = free.back();
+        free.pop_back();
+      }
+    }
+    ~lease () {
+      s_->pending.clear();
+      s_->active.clear();
+      s_->sons.clear();
+      pool().push_back(s_);
+    }
+    add_scratch * operator-> () const { return s_; }
+  };
+};
+
+/// Union of a sorted vector of GDDD, duplicates are removed from d.
+static GDDD add_sorted (std::vector<GDDD> & d) {
+  d.erase(std::unique(d.begin(), d.end()), d.end());
+  if (d.size() == 1) {
+    return d[0];
+  } else if (d.size() == 2) {
+    return d[0] + d[1];
+  } else {
+    DED e(_DED_Add::create(d));
+    return e.eval();
+  }
+}
+
 /* Transform */
 GDDD _DED_Add::eval() const{
   assert(parameters.size()>1);
   int variable=parameters.begin()->variable();
 
-  GDDD::Valuation value;
-  std::map<int,std::set<GDDD> > map_set;
-
 #ifdef EVDDD
   if (variable == DISTANCE) {
     /// Special distance node canonization
@@ -193,46 +504,86 @@ GDDD _DED_Add::eval() const{
 //       }
 //     }
     return GDDD (variable,min,succ);
-  } else {
-    /// normal node canonization
-#endif  
+  }
+  /// normal node canonization
+#endif
+  // k-way merge of the runs of the operands, that are sorted by value :
+  // the values are swept by intervals over which the set of runs holding them does not change
+  add_scratch::lease scratch;
+  std::vector<add_scratch::cursor> & pending = scratch->pending;
+  std::vector<add_scratch::cursor> & active = scratch->active;
+  std::vector<GDDD> & sons = scratch->sons;
+  GDDD::Builder value(variable);
+  pending.reserve(parameters.size());
   for(std::vector<GDDD>::const_iterator si=parameters.begin();si!=parameters.end();++si){
-    GDDD::const_iterator end = si->end();
-    for(GDDD::const_iterator vi=si->begin();vi!=end;++vi){
-      map_set[vi->first].insert(vi->second);
-    }
+    add_scratch::cursor c = { si->runs_begin(), si->runs_end() };
+    if (c.it != c.end)
+      pending.push_back(c);
   }
-#ifdef EVDDD
+  std::make_heap(pending.begin(), pending.end());
+  GDDD::wide_val_t lo = 0;
+  while (! pending.empty() || ! active.empty()) {
+    if (active.empty())
+      lo = pending.front().it->lo;
+    // activate the runs starting at lo
+    while (! pending.empty() && pending.front().it->lo == lo) {
+      std::pop_heap(pending.begin(), pending.end());
+      active.push_back(pending.back());
+      pending.pop_back();
+    }
+    // the interval ends with the first active run, or before the next run to start
+    GDDD::wide_val_t hi = pending.empty() ? std::numeric_limits<GDDD::val_t>::max() : pending.front().it->lo - GDDD::wide_val_t (1);
+    sons.clear();
+    for (std::vector<add_scratch::cursor>::const_iterator ci = active.begin(); ci != active.end(); ++ci) {
+      hi = std::min(hi, GDDD::wide_val_t (ci->it->hi));
+      sons.push_back(ci->it->son);
+    }
+
+    if (sons.size() == 1) {
+      value.add(lo, hi, sons[0]);
+    } else if (sons.size() == 2) {
+      value.add(lo, hi, sons[0] + sons[1]);
+    } else {
+      std::sort(sons.begin(), sons.end());
+      value.add(lo, hi, add_sorted(sons));
+    }
+
+    // move on the runs ending at hi
+    lo = hi + 1;
+    size_t kept = 0;
+    for (size_t i = 0; i < active.size(); ++i) {
+      add_scratch::cursor & c = active[i];
+      if (c.it->hi != hi) {
+        active[kept++] = c;
+      } else if (++c.it != c.end) {
+        pending.push_back(c);
+        std::push_heap(pending.begin(), pending.end());
+      }
+    }
+    active.resize(kept);
   }
-#endif
-  for(std::map<int,std::set<GDDD> >::const_iterator map_set_i=map_set.begin();map_set_i!=map_set.end();++map_set_i){
-    assert(map_set_i->second.size()!=0);
-    std::pair<int,GDDD> x;
-    x.first=map_set_i->first;
-    if(map_set_i->second.size()==1)
-      x.second=*(map_set_i->second.begin());
-    else
-      x.second=DED::add(map_set_i->second);
-    value.push_back(x);
-  }
-  return GDDD(variable,value);
+  return value.finalize();
 };
 
 /* constructor*/
 _DED *_DED_Add::create(const std::set<GDDD> &s){
-  assert(s.size()!=0); // s is not empty
-  std::set<GDDD> parameters=s;
-  parameters.erase(GDDD::null);
+  std::vector<GDDD> parameters(s.begin(),s.end());
+  return create(parameters);
+}
+
+_DED *_DED_Add::create(std::vector<GDDD> &parameters){
+  assert(parameters.size()!=0); // s is not empty
+  parameters.erase(std::remove(parameters.begin(),parameters.end(),GDDD::null),parameters.end());
   if(parameters.size()==1)
     return new _DED_GDDD(*parameters.begin());  
   else { 
     if(parameters.size()==0)
       return new _DED_GDDD(GDDD::null);
-    else if(parameters.find(GDDD::top)!=parameters.end()||parameters.find(GDDD::one)!=parameters.end()){ // 
+    else if(std::find(parameters.begin(),parameters.end(),GDDD::top)!=parameters.end()||std::find(parameters.begin(),parameters.end(),GDDD::one)!=parameters.end()){ // 
       return new _DED_GDDD(GDDD::top);
     }
     else{ 
-      std::set<GDDD>::const_iterator si=parameters.begin();
+      std::vector<GDDD>::const_iterator si=parameters.begin();
       int variable = si->variable();
       for(;(si!=parameters.end())?(variable == si->variable()):false;++si){}
       if(si!=parameters.end())// s contains at least 2 GDDDs with different variables
@@ -243,38 +594,79 @@ _DED *_DED_Add::create(const std::set<GDDD> &s){
 };
 
 /******************************************************************************/
-/*                    class _DED_Mult:public _DED                             */
+/*                    binary operations                                       */
 /******************************************************************************/
-class _DED_Mult:public _DED{
-private:
-  GDDD parameter1;
-  GDDD parameter2;
-  _DED_Mult(const GDDD &g1,const GDDD &g2):parameter1(g1),parameter2(g2){};
-public:
-  static  _DED *create(const GDDD &g1,const GDDD &g2);
-  /* Compare */
-  size_t hash() const;
-  bool operator==(const _DED &e)const;
-  _DED * clone () const { return new _DED_Mult(*this); }
-  /* Transform */
-  GDDD eval() const;
+// One step of the evaluation of a binary operation on distinct non terminal nodes
+// (over the same variable, except for concatenation). Results are cached by DED::binary.
+
+/// Sweeps the runs of two nodes by intervals of values over which neither node changes of son.
+/// f(lo, hi, son1, son2) is called on each such interval covered by g1 or g2, in increasing order,
+/// with son1 (resp. son2) the son of g1 (resp. g2) for these values, or null if it has none.
+template <typename F>
+static void sweep_runs (const GDDD &g1, const GDDD &g2, F & f) {
+  GDDD::const_run_iterator v1=g1.runs_begin();
+  GDDD::const_run_iterator v2=g2.runs_begin();
+  GDDD::const_run_iterator v1end=g1.runs_end();
+  GDDD::const_run_iterator v2end=g2.runs_end();
+  typedef GDDD::wide_val_t wide_val_t;
+  // greater than any value
+  const wide_val_t none = wide_val_t (std::numeric_limits<GDDD::val_t>::max()) + 1;
+  // values below lo are done
+  wide_val_t lo = std::numeric_limits<GDDD::val_t>::min();
+
+  while(v1!=v1end||v2!=v2end){
+    // the next value of each node
+    wide_val_t lo1 = v1!=v1end ? std::max(lo, wide_val_t(v1->lo)) : none;
+    wide_val_t lo2 = v2!=v2end ? std::max(lo, wide_val_t(v2->lo)) : none;
+    lo = std::min(lo1, lo2);
+    // the interval ends with a run, or before the other node starts a run
+    wide_val_t hi1 = lo1 == lo ? v1->hi : lo1 - 1;
+    wide_val_t hi2 = lo2 == lo ? v2->hi : lo2 - 1;
+    wide_val_t hi = std::min(hi1, hi2);
+    f(lo, hi, lo1 == lo ? v1->son : GDDD::null, lo2 == lo ? v2->son : GDDD::null);
+    lo = hi + 1;
+    if (v1!=v1end && v1->hi == hi)
+      ++v1;
+    if (v2!=v2end && v2->hi == hi)
+      ++v2;
+  }
+}
 
-  /* constructor*/
-  ~_DED_Mult(){};
-};
+/// Moves it to the first run of [it,end) whose values are not all lower than val.
+/// The next run is tested inline, longer moves go through GDDD::seek.
+static inline void skip_runs (GDDD::const_run_iterator & it, const GDDD::const_run_iterator & end, GDDD::wide_val_t val) {
+  if (it != end && it->hi < val && (++it != end && it->hi < val))
+    it = GDDD::seek(it, end, val);
+}
 
-/*********/
-/* Compare */
-size_t _DED_Mult::hash() const{
-  return parameter1.hash()+13*parameter2.hash();
-};
+namespace {
+  /// the steps of sweep_runs for binary operations, that fill a node
+  struct add_step {
+    GDDD::Builder & value;
+    void operator() (GDDD::val_t lo, GDDD::val_t hi, const GDDD & s1, const GDDD & s2) {
+      if (s1 == GDDD::null)
+        value.add(lo, hi, s2);
+      else if (s2 == GDDD::null)
+        value.add(lo, hi, s1);
+      else
+        value.add(lo, hi, s1 + s2);
+    }
+  };
+}
 
-bool _DED_Mult::operator==(const _DED &e)const{
-  return ((parameter1==((_DED_Mult*)&e)->parameter1)&&(parameter2==((_DED_Mult*)&e)->parameter2));
-};
+static GDDD eval_add (const GDDD &g1, const GDDD &g2) {
+  assert(g1.variable()==g2.variable());
+  int variable=g1.variable();
+#ifdef EVDDD
+  assert(variable != DISTANCE);
+#endif
+  GDDD::Builder value(variable);
+  add_step step = { value };
+  sweep_runs(g1, g2, step);
+  return value.finalize();
+}
 
-/* Transform */
-GDDD _DED_Mult::eval() const{
+static GDDD eval_mult (const GDDD &parameter1, const GDDD &parameter2) {
   assert(parameter1.variable()==parameter2.variable());
   int variable=parameter1.variable();
 #ifdef EVDDD
@@ -295,216 +687,90 @@ GDDD _DED_Mult::eval() const{
       succval = vv1->first;
       succ = vv1->second * vv2->second;
     }
-    
-//     if (succ != GDDD::one) {
-//       int minsucc=-1;
-//       for (GDDD::const_iterator it = succ.begin() ; it != succ.end() ; ++it) {
-// 	assert (it->second.nbsons() == 1);
-// 	GDDD::const_iterator succd = it->second.begin();
-// 	if (minsucc==-1 || succd->first < minsucc)
-// 	  minsucc = succd->first;
-//       }
-//       if (minsucc != 0) {
-// 	succval += minsucc;
-// 	succ = push (-minsucc) (succ);
-//       }
-//     }
-    
     return GDDD(variable,succval,succ);
   }
 #endif
 
-  GDDD::Valuation value;
-  std::map<int,std::set<GDDD> > map_set;
-  GDDD::const_iterator v1=parameter1.begin();
-  GDDD::const_iterator v2=parameter2.begin();
-  GDDD::const_iterator v1end=parameter1.end();
-  GDDD::const_iterator v2end=parameter2.end();
+  // only overlapping runs matter : skip the runs of a node that end before the other one's
+  GDDD::Builder value(variable);
+  GDDD::const_run_iterator v1=parameter1.runs_begin();
+  GDDD::const_run_iterator v2=parameter2.runs_begin();
+  GDDD::const_run_iterator v1end=parameter1.runs_end();
+  GDDD::const_run_iterator v2end=parameter2.runs_end();
 
   while(v1!=v1end&&v2!=v2end){
-    if(v1->first<v2->first)
-      ++v1;
-    else if(v1->first>v2->first)
-      ++v2;
+    if(v1->hi<v2->lo)
+      skip_runs(v1,v1end,v2->lo);
+    else if(v2->hi<v1->lo)
+      skip_runs(v2,v2end,v1->lo);
     else{
-      GDDD g=(v1->second)*(v2->second);
+      GDDD::val_t hi=std::min(v1->hi,v2->hi);
+      GDDD g=(v1->son)*(v2->son);
       if(g!=GDDD::null){
-        std::pair<int,GDDD> x;
-	x.first=v1->first;
-	x.second=g;
-	value.push_back(x);
+	value.add(std::max(v1->lo,v2->lo),hi,g);
       }
-      ++v1;
-      ++v2;
+      if(v1->hi==hi)
+	++v1;
+      if(v2->hi==hi)
+	++v2;
     }
   }
-  return GDDD(variable,value);
-};
-
-/* constructor*/
-_DED *_DED_Mult::create(const GDDD &g1,const GDDD &g2){
-  if(g1==g2)
-    return new _DED_GDDD(g1);
-  else if(g1==GDDD::null||g2==GDDD::null)
-    return new _DED_GDDD(GDDD::null);
-  else if(g1==GDDD::one||g2==GDDD::one||g1==GDDD::top||g2==GDDD::top)
-    return new _DED_GDDD(GDDD::top);
-  else if(g1.variable()!=g2.variable())
-    return new _DED_GDDD(GDDD::null);
-  else if(g1.hash() < g2.hash())
-    return new _DED_Mult(g1,g2);
-  else
-    return new _DED_Mult(g2,g1);
-};
-
-
-/******************************************************************************/
-/*                    class _DED_Minus:public _DED                            */
-/******************************************************************************/
-class _DED_Minus:public _DED{
-private:
-  GDDD parameter1;
-  GDDD parameter2;
-  _DED_Minus(const GDDD &g1,const GDDD &g2):parameter1(g1),parameter2(g2){};
-public:
-  static  _DED *create(const GDDD &g1,const GDDD &g2);
-  /* Compare */
-  size_t hash() const;
-  bool operator==(const _DED &e)const;
-  _DED * clone () const { return new _DED_Minus(*this); }
-  /* Transform */
-  GDDD eval() const;
-
-  /* constructor*/
-  ~_DED_Minus(){};
-};
-
-/*********/
-/* Compare */
-size_t _DED_Minus::hash() const{
-  return 617*parameter1.hash() +307*parameter2.hash();
-};
-
-bool _DED_Minus::operator==(const _DED &e)const{
-  return ((parameter1==((_DED_Minus*)&e)->parameter1)&&(parameter2==((_DED_Minus*)&e)->parameter2));
-};
+  return value.finalize();
+}
 
-/* Transform */
-GDDD _DED_Minus::eval() const{
+static GDDD eval_minus (const GDDD &parameter1, const GDDD &parameter2) {
   assert(parameter1.variable()==parameter2.variable());
   int variable=parameter1.variable();
-  GDDD::Valuation value;
 
-  //  std::map<int,std::set<GDDD> > std::map_std::set;
-  GDDD::const_iterator v1=parameter1.begin();
-  GDDD::const_iterator v2=parameter2.begin();
 #ifdef EVDDD
   if (variable == DISTANCE) {
+    GDDD::const_iterator v1=parameter1.begin();
+    GDDD::const_iterator v2=parameter2.begin();
     assert(parameter1.nbsons() == 1);
     assert(parameter2.nbsons() == 1);
     return GDDD(variable,v1->first,v1->second - v2->second);
   }
 #endif
-  GDDD::const_iterator v1end=parameter1.end();
-  GDDD::const_iterator v2end=parameter2.end();
-
-  while(v1!=v1end&&v2!=v2end){
-    if(v1->first<v2->first){
-      std::pair<int,GDDD> x(v1->first,v1->second);
-      value.push_back(x);
-      v1++;
-    }
-    else if(v1->first>v2->first)
-      v2++;
-    else{
-      GDDD g=(v1->second)-(v2->second);
+  // every run of parameter1 is kept, minus the runs of parameter2 it overlaps
+  GDDD::Builder value(variable);
+  GDDD::const_run_iterator v1=parameter1.runs_begin();
+  GDDD::const_run_iterator v2=parameter2.runs_begin();
+  GDDD::const_run_iterator v1end=parameter1.runs_end();
+  GDDD::const_run_iterator v2end=parameter2.runs_end();
+
+  for(;v1!=v1end;++v1){
+    // values of the run lower than lo are done
+    GDDD::wide_val_t lo=v1->lo;
+    while(lo<=v1->hi){
+      skip_runs(v2,v2end,lo);
+      if(v2==v2end||v2->lo>v1->hi){
+	value.add(lo,v1->hi,v1->son);
+	break;
+      }
+      if(v2->lo>lo){
+	value.add(lo,v2->lo-GDDD::wide_val_t(1),v1->son);
+	lo=v2->lo;
+      }
+      GDDD::wide_val_t hi=std::min(v1->hi,v2->hi);
+      GDDD g=(v1->son)-(v2->son);
       if(g!=GDDD::null){
-        std::pair<int,GDDD> x(v1->first,g);
-	value.push_back(x);
+	value.add(lo,hi,g);
       }
-      v1++;
-      v2++;
+      lo=hi+1;
     }
   }
+  return value.finalize();
+}
 
-  for(;v1!=parameter1.end();++v1){
-    value.push_back(std::make_pair(v1->first,v1->second));
-  }
-
-  return GDDD(variable,value);
-};
-
-/* constructor*/
-_DED *_DED_Minus::create(const GDDD &g1,const GDDD &g2){
-  if(g1 == GDDD::top && g2 == GDDD::top)
-    return new _DED_GDDD(GDDD::top);
-  if(g1==g2||g1==GDDD::null)
-    return new _DED_GDDD(GDDD::null);
-  else if(g2==GDDD::null)
-    return new _DED_GDDD(g1);
-  else if(g1==GDDD::one||g2==GDDD::one||g1==GDDD::top||g2==GDDD::top)
-    return new _DED_GDDD(GDDD::top);
-  else if(g1.variable()!=g2.variable())
-    return new _DED_GDDD(g1);
-  else
-    return new _DED_Minus(g1,g2);
-};
-
-/******************************************************************************/
-/*                    class _DED_Concat:public _DED                           */
-/******************************************************************************/
-class _DED_Concat:public _DED{
-private:
-  GDDD parameter1;
-  GDDD parameter2;
-  _DED_Concat(const GDDD &g1,const GDDD &g2):parameter1(g1),parameter2(g2){};
-public:
-  static _DED *create(const GDDD &g1,const GDDD &g2);
-  /* Compare */
-  size_t hash() const;
-  bool operator==(const _DED &e)const;
-  _DED * clone () const { return new _DED_Concat(*this); }
-  /* Transform */
-  GDDD eval() const;
-
-  /* constructor*/
-  ~_DED_Concat(){};
-};
-
-/*********/
-/* Compare */
-size_t _DED_Concat::hash() const{
-  return 827*parameter1.hash()+1153*parameter2.hash();
-};
-
-bool _DED_Concat::operator==(const _DED &e)const{
-  return ((parameter1==((_DED_Concat*)&e)->parameter1)&&(parameter2==((_DED_Concat*)&e)->parameter2));
-};
-
-/* Transform */
-GDDD _DED_Concat::eval() const{
+static GDDD eval_concat (const GDDD &parameter1, const GDDD &parameter2) {
   int variable=parameter1.variable();
-  GDDD::Valuation value;
-  std::map<int,std::set<GDDD> > map_set;
-    GDDD::const_iterator v1end=parameter1.end();
-    for(GDDD::const_iterator v1=parameter1.begin();v1!=v1end;++v1){
-    std::pair<int,GDDD> x(v1->first,(v1->second)^parameter2);
-    value.push_back(x);
-  }
-  return GDDD(variable,value);
-};
-
-/* constructor*/
-_DED * _DED_Concat::create(const GDDD &g1,const GDDD &g2){
-  if(g1==GDDD::null||g2==GDDD::null)
-    return new _DED_GDDD(GDDD::null);
-  else if(g1==GDDD::one)
-    return new _DED_GDDD(g2);
-  else if(g1==GDDD::top)
-    return new _DED_GDDD(GDDD::top);
-  else
-    return new _DED_Concat(g1,g2);
-};
+  GDDD::Builder value(variable);
+  GDDD::const_run_iterator v1end=parameter1.runs_end();
+  for(GDDD::const_run_iterator v1=parameter1.runs_begin();v1!=v1end;++v1){
+    value.add(v1->lo,v1->hi,(v1->son)^parameter2);
+  }
+  return value.finalize();
+}
 
 /******************************************************************************/
 /*                    class _DED_Concat:public _DED                           */
@@ -523,6 +789,7 @@ public:
   size_t hash() const;
   bool operator==(const _DED &e)const;
   _DED * clone () const { return new _DED_Hom(*this); }
+  bool is_marked() const { return hom.is_marked() && parameter.is_marked(); }
 
   /* Transform */
   GDDD eval() const;
@@ -561,13 +828,18 @@ _DED * _DED_Hom::create(const GHom &g,const GDDD &d){
 
   /* Memory Manager */
 unsigned int DED::statistics() {
-  return cache.size();
+  return cache.size() + computed.used();
 }
 
 void DED::pstats(bool reinit)
 {
-  std::cout << "*\nCache Stats : size=" << cache.size() << std::endl;  
-  std::cout << "\nCache hit ratio : " << double (Hits*100) / double(Misses+1+Hits) << "%" << std::endl;
+  std::cout << "*\nCache Stats : size=" << cache.size() + computed.used() << std::endl;  
+  std::cout << "Computed table : " << computed.used() << " entries used out of " << computed.size()
+	    << ", hit ratio " << double (computed.hits()*100) / double(computed.misses()+1+computed.hits()) << "%" << std::endl;
+  size_t hits = Hits + computed.hits();
+  size_t misses = Misses + computed.misses();
+  std::cout << "\nCache hit ratio : " << double (hits*100) / double(misses+1+hits) << "%" << std::endl;
+  std::cout << "Cache entries kept/dropped by garbage collections : " << DEDkept << "/" << DEDdropped << std::endl;
   
 #ifdef HASH_STAT
   std::cout << std::endl << "DED Unicity table stats :" << std::endl;
@@ -577,12 +849,15 @@ void DED::pstats(bool reinit)
   if (reinit){
     Hits = 0;
     Misses = 0;  
+    computed.reset_stats();
+    DEDkept = 0;
+    DEDdropped = 0;
   }  
 
 }
 
 #ifdef REENTRANT
-static tbb::atomic<size_t> DEDpeak;
+static std::atomic<size_t> DEDpeak;
 class DEDpeak_parallel_init
 {
 public:
@@ -600,32 +875,44 @@ static size_t DEDpeak = 0;
 #endif
 
 size_t DED::peak() {
-  if (cache.size() > DEDpeak)
-    DEDpeak = cache.size();
+  if (statistics() > DEDpeak)
+    DEDpeak = statistics();
   return DEDpeak;
 }
 // Todo
 void DED::garbage(){
-  if (cache.size() > DEDpeak)
-    DEDpeak = cache.size();
-  std::vector<_DED *> todel;
-  todel.reserve(cache.size());
-  for(Cache::iterator di=cache.begin();di!=cache.end();di++)
-    {
-      todel.push_back(di->first.concret);
-    } 
-  cache.clear();
-  for (std::vector<_DED *>::iterator it =todel.begin() ; it != todel.end() ; ++it) {
-    delete *it;
-  }
-
-  //cache.clear();
+  if (statistics() > DEDpeak)
+    DEDpeak = statistics();
+
+  // keep the entries whose operands and result survive, the others are dropped and their key freed
+  struct dead_entry {
+    bool operator() (const std::pair<const DED, Stamped<GDDD> > & e) const {
+      if (e.first.concret->is_marked() && e.second.value.is_marked())
+	return false;
+      delete e.first.concret;
+      return true;
+    }
+  };
+  struct marked_id {
+    bool operator() (GDDD::id_t id) const {
+      return GDDD(id).is_marked();
+    }
+  };
+  size_t dropped = cache.erase_if(dead_entry()) + computed.sweep(marked_id());
+  DEDdropped += dropped;
+  DEDkept += statistics();
 }; 
 
+void DED::setComputedTableSize(size_t nb_entries){
+  computed.set_max_size(nb_entries);
+}
+
 
 bool DED::operator==(const DED& e) const{
   if (concret==NULL)
     return e.concret == NULL;
+  else if (e.concret == NULL)
+    return false;
   else if(typeid(*concret)!=typeid(*(e.concret)))
     return false;
   else 
@@ -657,15 +944,18 @@ DED::eval()
 		Misses++;
 		GDDD res = concret->eval(); 
         cache.insert(access,*this);
-        access->second = res;
+        access->second.value = res;
+        access->second.stamp = CacheBudget::tick();
 		concret = NULL;
+		CacheBudget::inserted(cache_budget.entry_bytes());
 		return res;
     }
   else
     {
       Hits++;
       delete concret;
-      return access->second;
+      access->second.stamp = CacheBudget::tick();
+      return access->second.value;
     }
 
 }
@@ -688,32 +978,111 @@ GDDD DED::add(const std::set<GDDD> &s){
     return GDDD::null;
   } else if (s.size() == 1) {
     return *s.begin();
+  } else if (s.size() == 2) {
+    return *s.begin() + *s.rbegin();
   } else {
     DED e(_DED_Add::create(s));
     return e.eval();
   }
 };
 
+GDDD DED::add(std::vector<GDDD> &s){
+  if (s.empty()) {
+    return GDDD::null;
+  }
+  std::sort(s.begin(), s.end());
+  return add_sorted(s);
+}
+
+GDDD DED::binary(binary_op op, const GDDD &g1, const GDDD &g2){
+  GDDD::id_t a = g1.concret;
+  GDDD::id_t b = g2.concret;
+  // addition and intersection are commutative : share the entries of (g1,g2) and (g2,g1)
+  if ((op == ADD || op == MULT) && a > b)
+    std::swap(a,b);
+  GDDD::id_t res;
+  if (computed.find(op,a,b,res))
+    return GDDD(res);
+
+  GDDD r;
+  switch (op) {
+  case ADD :
+    r = eval_add(g1,g2);
+    break;
+  case MULT :
+    r = eval_mult(g1,g2);
+    break;
+  case MINUS :
+    r = eval_minus(g1,g2);
+    break;
+  case CONCAT :
+    r = eval_concat(g1,g2);
+    break;
+  }
+  computed.insert(op,a,b,r.concret);
+  return r;
+}
+
 GDDD operator+(const GDDD &g1,const GDDD &g2){
-  d3::set<GDDD>::type s;
-  s.insert(g1);
-  s.insert(g2);
-  return DED::add(s);
+  if(g1==g2||g2==GDDD::null)
+    return g1;
+  else if(g1==GDDD::null)
+    return g2;
+  else if(g1==GDDD::one||g2==GDDD::one||g1==GDDD::top||g2==GDDD::top)
+    return GDDD::top;
+  else if(g1.variable()!=g2.variable())
+    return GDDD::top;
+#ifdef EVDDD
+  else if(g1.variable()==DISTANCE){
+    // distance nodes are canonized by the n-ary addition
+    std::set<GDDD> s;
+    s.insert(g1);
+    s.insert(g2);
+    DED e(_DED_Add::create(s));
+    return e.eval();
+  }
+#endif
+  else
+    return DED::binary(DED::ADD,g1,g2);
 }
 
 GDDD operator*(const GDDD &g1,const GDDD &g2){
-  DED e(_DED_Mult::create(g1,g2));
-  return e.eval();
+  if(g1==g2)
+    return g1;
+  else if(g1==GDDD::null||g2==GDDD::null)
+    return GDDD::null;
+  else if(g1==GDDD::one||g2==GDDD::one||g1==GDDD::top||g2==GDDD::top)
+    return GDDD::top;
+  else if(g1.variable()!=g2.variable())
+    return GDDD::null;
+  else
+    return DED::binary(DED::MULT,g1,g2);
 }
 
 GDDD operator^(const GDDD &g1,const GDDD &g2){
-  DED e(_DED_Concat::create(g1,g2));
-  return e.eval();
+  if(g1==GDDD::null||g2==GDDD::null)
+    return GDDD::null;
+  else if(g1==GDDD::one)
+    return g2;
+  else if(g1==GDDD::top)
+    return GDDD::top;
+  else
+    return DED::binary(DED::CONCAT,g1,g2);
 }
 
 GDDD operator-(const GDDD &g1,const GDDD &g2){
-  DED e(_DED_Minus::create(g1,g2));
-  return e.eval();
+  if(g1 == GDDD::top && g2 == GDDD::top)
+    return GDDD::top;
+  if(g1==g2||g1==GDDD::null)
+    return GDDD::null;
+  else if(g2==GDDD::null)
+    return g1;
+  else if(g1==GDDD::one||g2==GDDD::one||g1==GDDD::top||g2==GDDD::top)
+    return GDDD::top;
+  else if(g1.variable()!=g2.variable())
+    return g1;
+  else
+    return DED::binary(DED::MINUS,g1,g2);
 }
 
 /******************************************************************************/
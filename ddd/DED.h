@@ -38,6 +38,18 @@ class DED{
 private:
   friend struct std::equal_to<DED>;
   _DED *concret;
+
+  /// The binary operations, stored in the computed table rather than in the DED cache.
+  enum binary_op { ADD = 1, MULT, MINUS, CONCAT };
+  /// Cached evaluation of a binary operation, operands are expected to be already simplified
+  /// (distinct non terminal nodes over the same variable, see the GDDD operators in DED.cpp).
+  static GDDD binary (binary_op op, const GDDD &, const GDDD &);
+  friend GDDD operator+(const GDDD &,const GDDD &);
+  friend GDDD operator*(const GDDD &,const GDDD &);
+  friend GDDD operator-(const GDDD &,const GDDD &);
+  friend GDDD operator^(const GDDD &,const GDDD &);
+  /// Bounds the cache by the cache budget, frees the keys it evicts.
+  friend class DEDCacheBudget;
 public:
   GDDD eval();
   DED(_DED *c):concret(c){};
@@ -45,13 +57,21 @@ public:
   DED():concret(NULL){};
   bool operator==(const DED&) const; 
   static GDDD add(const d3::set<GDDD>::type &);
+  /// Union of the GDDD of s, in any order and possibly repeated. s is sorted and deduplicated.
+  static GDDD add(std::vector<GDDD> &s);
   static GDDD hom(const GHom &,const GDDD&);
 
   /* Memory Manager */
   static  unsigned int statistics();
   static void pstats(bool reinit=true);
   static size_t peak();
+  /// Drops the cache entries that refer to an object not marked by the collection in progress,
+  /// see MemoryManager::garbage().
   static void garbage(); 
+  /// Bound the computed table of binary operations to nb_entries entries (rounded up to a power of two).
+  /// The table starts small and doubles when half full, until this bound is reached.
+  /// Resizing below the current size drops the cached results. Default is 1<<22 entries (16 bytes each).
+  static void setComputedTableSize(size_t nb_entries);
   /// For storage in a hash table
   size_t hash () const ;
 };
@@ -71,6 +91,8 @@ public:
   virtual size_t hash() const =0;
   virtual bool operator==(const _DED &) const=0;
   virtual _DED * clone () const=0;
+  /// For garbage collection : whether all the operands survive the collection in progress.
+  virtual bool is_marked() const=0;
 
   /* Transform */
   virtual GDDD eval() const=0; 
@@ -23,11 +23,14 @@
 #include <typeinfo>
 #include <iostream>
 #include <cassert>
+#include <utility>
 #include <map>
 #include <algorithm>
+#include <climits>
 
 #include "ddd/util/set.hh"
 #include "ddd/Hom.h"
+#include "ddd/StaticStrongHom.hh"
 #include "ddd/DDD.h"
 #include "ddd/DED.h"
 #include "ddd/UniqueTable.h"
@@ -38,6 +41,11 @@
 #include "ddd/MemoryManager.h"
 #include "ddd/FixObserver.hh"
 
+#ifdef PARALLEL_DD
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
 namespace d3 { namespace util {
   template<>
   struct equal<_GHom*>{
@@ -252,14 +260,14 @@ public:
 
       if (d.variable() != target) {
 	// destroy/propagate
-	GDDD::const_iterator dend = d.end();
-	for ( GDDD::const_iterator it = d.begin(); it != dend; ++it)
-	  sum.insert( GHom(this) (it->second) );
+	GDDD::const_run_iterator dend = d.runs_end();
+	for ( GDDD::const_run_iterator it = d.runs_begin(); it != dend; ++it)
+	  sum.insert( GHom(this) (it->son) );
       } else {
 	// grab all arc values and fuse them
-	GDDD::const_iterator dend = d.end();
-	for ( GDDD::const_iterator it = d.begin(); it != dend; ++it)
-	  sum.insert( GDDD (target,it->first) );
+	GDDD::const_run_iterator dend = d.runs_end();
+	for ( GDDD::const_run_iterator it = d.runs_begin(); it != dend; ++it)
+	  sum.insert( GDDD (target,it->lo,it->hi) );
       }
 
       return DED::add(sum);
@@ -496,7 +504,7 @@ public:
   typedef param_t::const_iterator param_it;
 
   typedef std::pair< GHom , std::set<GHom> > partition;
-  typedef std::map<int,partition> partition_cache_type;
+  typedef hash_map<int,partition>::type partition_cache_type;
 
   // public for direct manipulation in fixpoint
   param_t parameters;
@@ -565,17 +573,17 @@ public:
       {
 	int var = d.variable();
 	
-	partition_cache_type::iterator part_it = partition_cache.find(var);
-	if( part_it == partition_cache.end() )
+	partition_cache_type::const_accessor part_it;
+	if( ! partition_cache.find(part_it,var) )
           {
 	    this->skip_variable(var);
-	    part_it = partition_cache.find(var);
+	    partition_cache.find(part_it,var);
           }              
 	
-	GHom& F = part_it->second.first;
-        std::set<GHom> & G = part_it->second.second;
+	const GHom& F = part_it->second.first;
+        const std::set<GHom> & G = part_it->second.second;
         
-	for( std::set<GHom>::iterator it = G.begin() ; it != G.end(); ++it)
+	for( std::set<GHom>::const_iterator it = G.begin() ; it != G.end(); ++it)
 	  {
 	    GDDD img = it->has_image(d);
 	    if (! (img == GDDD::null)) {
@@ -612,7 +620,9 @@ public:
   get_partition(int var) const
   {
         this->skip_variable(var);
-        return partition_cache.find(var)->second;
+        partition_cache_type::const_accessor caccess;
+        partition_cache.find(caccess,var);
+        return caccess->second;
   }
 
   GHom invert  (const GDDD & pot) const {
@@ -655,10 +665,14 @@ public:
   bool
   skip_variable(int var) const
   {
-    partition_cache_type::iterator part_it = partition_cache.find(var);
-    if( part_it == partition_cache.end() )
+    partition_cache_type::const_accessor caccess;
+    if( ! partition_cache.find(caccess,var) )
       {
-	partition& part = partition_cache.insert(std::make_pair(var,partition())).first->second;
+	// miss
+	partition_cache_type::accessor access;
+	partition_cache.insert(access,var);
+	partition& part = access->second;
+	part.second.clear();
 	
 	std::set<GHom> F;
 	for(param_it gi=parameters.begin();gi!=parameters.end();++gi)
@@ -677,7 +691,8 @@ public:
 	part.first = GHom::add(F);
 	return part.second.empty();
       }
-    return part_it->second.second.empty();
+    // cache hit
+    return caccess->second.second.empty();
   }
   
   /* Eval */
@@ -703,17 +718,17 @@ public:
           std::set<GDDD> s;
           int var = d.variable();
                     
-          partition_cache_type::iterator part_it = partition_cache.find(var);
-          if( part_it == partition_cache.end() )
+          partition_cache_type::const_accessor part_it;
+          if( ! partition_cache.find(part_it,var) )
           {
               this->skip_variable(var);
-              part_it = partition_cache.find(var);
+              partition_cache.find(part_it,var);
           }              
           
-          GHom& F = part_it->second.first;
-        std::set<GHom> & G = part_it->second.second;
+          const GHom& F = part_it->second.first;
+        const std::set<GHom> & G = part_it->second.second;
           
-          for( std::set<GHom>::iterator it = G.begin() ; it != G.end(); ++it)
+          for( std::set<GHom>::const_iterator it = G.begin() ; it != G.end(); ++it)
 	    {
 	      s.insert((*it)(d));                  
 	    } 
@@ -758,7 +773,7 @@ public:
   typedef param_t::const_iterator param_it;
 
   typedef std::pair< GHom , param_t > partition;
-  typedef std::map<int,partition> partition_cache_type;
+  typedef hash_map<int,partition>::type partition_cache_type;
 
 
 private:
@@ -797,7 +812,9 @@ public:
   get_partition(int var)
   {
         this->skip_variable(var);
-        return partition_cache.find(var)->second;
+        partition_cache_type::const_accessor caccess;
+        partition_cache.find(caccess,var);
+        return caccess->second;
   }
 
   GHom invert  (const GDDD & pot) const {
@@ -835,10 +852,14 @@ public:
   bool
   skip_variable(int var) const
   {
-    partition_cache_type::iterator part_it = partition_cache.find(var);
-    if( part_it == partition_cache.end() )
+    partition_cache_type::const_accessor caccess;
+    if( ! partition_cache.find(caccess,var) )
       {
-	partition& part = partition_cache.insert(std::make_pair(var,partition())).first->second;
+	// miss
+	partition_cache_type::accessor access;
+	partition_cache.insert(access,var);
+	partition& part = access->second;
+	part.second.clear();
 	
 	std::set<GHom> F;
 	for(param_it gi=parameters.begin();gi!=parameters.end();++gi)
@@ -857,7 +878,8 @@ public:
 	part.first = monotonic(F);
 	return part.second.empty();
       }
-    return part_it->second.second.empty();
+    // cache hit
+    return caccess->second.second.empty();
   }
   
   /* Eval */
@@ -873,15 +895,15 @@ public:
 	std::set<GDDD> s;
 	int var = d.variable();
         
-	partition_cache_type::iterator part_it = partition_cache.find(var);
-	if( part_it == partition_cache.end() )
+	partition_cache_type::const_accessor part_it;
+	if( ! partition_cache.find(part_it,var) )
           {
 	    this->skip_variable(var);
-	    part_it = partition_cache.find(var);
+	    partition_cache.find(part_it,var);
           }              
 	
-	GHom& F = part_it->second.first;
-	param_t & G = part_it->second.second;
+	const GHom& F = part_it->second.first;
+	const param_t & G = part_it->second.second;
 	
 	
 	GDDD d1 = d;
@@ -1222,6 +1244,8 @@ class LeftConcat
 {
 
 private:
+    // RecFireSat saturates the image of right
+    friend class RecFireSat;
 
     GDDD left;
     GHom right;
@@ -1372,6 +1396,271 @@ public:
 
 };
 
+#ifdef PARALLEL_DD
+
+// lookup in the GHom cache, defined below ; immediate homomorphisms always miss
+static std::pair<bool,GDDD> cached_image (const GHom & h, const GDDD & d);
+
+namespace {
+
+typedef tbb::blocked_range<size_t> operand_range;
+
+/// task body : val[i] = h(val[i]) for the indexes i listed in to_solve, where h is homs[0]
+/// if there is a single homomorphism, homs[i] otherwise
+class hom_for
+{
+  const std::vector<GHom> & homs_;
+  std::vector<GDDD> & val_;
+  const std::vector<size_t> & to_solve_;
+
+public:
+  hom_for (const std::vector<GHom> & homs, std::vector<GDDD> & val, const std::vector<size_t> & to_solve)
+    : homs_(homs), val_(val), to_solve_(to_solve) {}
+
+  void operator() (const operand_range & range) const
+  {
+    for (size_t k = range.begin(); k != range.end(); ++k) {
+      size_t i = to_solve_[k];
+      val_[i] = homs_[homs_.size() == 1 ? 0 : i] (val_[i]);
+    }
+  }
+};
+
+/// Computes all the images val[i] = h(val[i]), h as in hom_for.
+/// A task costs more than a cache hit, so the hits are picked up first, then the misses
+/// are solved in parallel, one task each.
+void parallel_images (const std::vector<GHom> & homs, std::vector<GDDD> & val)
+{
+  std::vector<size_t> to_solve;
+  to_solve.reserve(val.size());
+  for (size_t i = 0; i < val.size(); ++i) {
+    std::pair<bool,GDDD> hit = cached_image(homs[homs.size() == 1 ? 0 : i], val[i]);
+    if (hit.first) {
+      val[i] = hit.second;
+    } else {
+      to_solve.push_back(i);
+    }
+  }
+  if (to_solve.size() == 1) {
+    hom_for(homs, val, to_solve) (operand_range(0, 1));
+  } else if (! to_solve.empty()) {
+    // grain 1 : one task per miss
+    tbb::parallel_for(operand_range(0, to_solve.size(), 1), hom_for(homs, val, to_solve));
+  }
+}
+
+} // anonymous namespace
+
+#endif // PARALLEL_DD
+
+namespace {
+
+/// orders homomorphisms by the lowest variable they affect, those that affect all
+/// variables last, for the CHAINING and RECFIREANDSAT saturation strategies
+struct variable_order {
+  static int lowest (const GHom & h) {
+    GHom::range_t range = h.get_range();
+    return range.empty() ? INT_MAX : *range.begin();
+  }
+  bool operator() (const std::pair<int,GHom> & a, const std::pair<int,GHom> & b) const {
+    return a.first < b.first || (a.first == b.first && a.second < b.second);
+  }
+};
+
+} // anonymous namespace
+
+/************************** RecFireSat */
+
+// predeclaration
+static GHom recFireSat (const GHom & sat, const GHom & g);
+
+/// The recursive fire and saturate of the RECFIREANDSAT saturation strategy, as sns::RecFireSat
+/// for SDD : RecFireSat(sat,g) (d) = sat* (g (d)), where sat = Id + F is an union containing
+/// the identity.
+/// Over a node of variable var, sat is split into the part F' that skips var and the rest G'.
+/// Only the states produced by g are saturated, arc by arc :
+///  - if g skips var, it is fired on each son, whose image is saturated by RecFireSat(F',g),
+///  - if g is a StrongHom whose phi returns left ^ h (or a composition of it), the image of a son is left ^ RecFireSat(F',h) (son),
+///    provided F' skips the variables of left,
+///  - otherwise the image g(d) is saturated by F'*.
+/// The result is then saturated by sat* if G' is not empty.
+class RecFireSat
+    	:
+        public _GHom
+{
+    GHom sat;
+    GHom g;
+
+    /// phi of the StrongHom g, with the homomorphisms it returns rewritten to saturate
+    /// their image by F*
+    struct saturated_phi {
+      const StrongHom & h;
+      const GHom & F;
+      mutable GHom last;
+      mutable GHom last_image;
+
+      saturated_phi (const StrongHom & hh, const GHom & FF) : h(hh), F(FF) {}
+
+      /// whether F skips all the variables of d
+      bool skips (const GDDD & d) const {
+        if (d == GDDD::one || d == GDDD::null)
+          return true;
+        if (d == GDDD::top || ! F.skip_variable(d.variable()))
+          return false;
+        for (GDDD::const_run_iterator it = d.runs_begin(); it != d.runs_end(); ++it)
+          if (! skips(it->son))
+            return false;
+        return true;
+      }
+
+      /// whether h is left ^ right, possibly composed with other homomorphisms :
+      /// (left ^ r) & h2 = left ^ (r & h2), and the parameters of an And commute
+      static bool split_concat (const GHom & h, GDDD & left, GHom & right) {
+        const _GHom * concret = get_concret(h);
+        if (const LeftConcat * lc = dynamic_cast<const LeftConcat *> (concret)) {
+          left = lc->left;
+          right = lc->right;
+          return true;
+        } else if (const Compose * comp = dynamic_cast<const Compose *> (concret)) {
+          if (split_concat(comp->left, left, right)) {
+            right = right & comp->right;
+            return true;
+          }
+        } else if (const And * hand = dynamic_cast<const And *> (concret)) {
+          for (And::parameters_it it = hand->parameters.begin() ; it != hand->parameters.end() ; ++it) {
+            if (const LeftConcat * lc = dynamic_cast<const LeftConcat *> (get_concret(*it))) {
+              left = lc->left;
+              right = lc->right;
+              for (And::parameters_it jt = hand->parameters.begin() ; jt != hand->parameters.end() ; ++jt)
+                if (jt != it)
+                  right = right & *jt;
+              return true;
+            }
+          }
+        }
+        return false;
+      }
+
+      GHom operator() (int var, int val) const {
+        GHom next = h.phi(var, val);
+        // consecutive values of a run mostly share their homomorphism
+        if (next == last)
+          return last_image;
+        last = next;
+        GDDD left;
+        GHom right;
+        if (next == GHom(GDDD::null)) {
+          last_image = next;
+        } else if (split_concat(next, left, right) && skips(left)) {
+          last_image = GHom(LeftConcat(left, recFireSat(F, right)));
+        } else {
+          last_image = fixpoint(F) & next;
+        }
+        return last_image;
+      }
+    };
+
+public:
+    RecFireSat (const GHom & s, const GHom & gg, int ref=0)
+    	:
+        _GHom(ref,false),
+        sat(s),
+        g(gg)
+    {
+    }
+
+    bool operator==(const _GHom &h) const
+    {
+        return sat == ((const RecFireSat*)&h )->sat && g == ((const RecFireSat*)&h )->g;
+    }
+
+    size_t
+    hash() const
+    {
+        return 19381 * sat.hash() + 19681 * g.hash();
+    }
+
+  _GHom * clone () const {  return new RecFireSat(*this); }
+
+    bool
+    skip_variable(int var) const
+    {
+        return sat.skip_variable(var) && g.skip_variable(var);
+    }
+
+  const GHom::range_t  get_range () const {
+    GHom::range_t ret = sat.get_range();
+    if ( ret.empty() )
+      return ret;
+    GHom::range_t pret = g.get_range();
+    if ( pret.empty() )
+      return pret;
+    ret.insert(pret.begin() , pret.end()) ;
+    return ret;
+  }
+
+  bool is_selector () const {
+    return sat.is_selector() && g.is_selector();
+  }
+
+    GDDD
+    eval(const GDDD &d) const
+    {
+        if( d == GDDD::null )
+        {
+            return GDDD::null;
+        }
+        else if( d == GDDD::one || d == GDDD::top )
+        {
+            return (fixpoint(sat) & g) (d);
+        }
+        int variable = d.variable();
+        // built by recFireSat only if sat is an union containing the identity
+        const Add * add = (const Add *) get_concret(sat);
+        Add::partition partition = add->get_partition(variable);
+        const GHom & F = partition.first;
+
+        GDDD image;
+        if (g.skip_variable(variable)) {
+            GHom Fsat = recFireSat(F, g);
+            GDDD::Builder v (variable);
+            for (GDDD::const_run_iterator it = d.runs_begin() ; it != d.runs_end() ; ++it) {
+                GDDD son = Fsat (it->son);
+                if (son != GDDD::null) {
+                    v.add(it->lo, it->hi, son);
+                }
+            }
+            image = v.finalize();
+        } else if (const StrongHom * strong = dynamic_cast<const StrongHom *> (get_concret(g))) {
+            image = d3::util::strong_eval(d, saturated_phi(*strong, F), strong->group_arcs());
+        } else {
+            image = fixpoint(F) (g (d));
+        }
+
+        if (partition.second.empty() || image == GDDD::null) {
+            return image;
+        }
+        return fixpoint(sat) (image);
+    }
+
+    void mark() const{
+        sat.mark();
+        g.mark();
+    }
+
+  void print (std::ostream & os) const {
+    os << "(RecFireSat:" << sat << " , " << g << ")";
+  }
+};
+
+static GHom recFireSat (const GHom & sat, const GHom & g) {
+    const _GHom * concret = _GHom::get_concret(sat);
+    if (typeid(*concret) == typeid(Add) && ((const Add *) concret)->get_have_id()) {
+        return RecFireSat(sat, g);
+    }
+    return fixpoint(sat) & g;
+}
+
 /************************** Fixpoint */
 class Fixpoint
     	:
@@ -1459,6 +1748,50 @@ public:
 
  
     /* Eval */
+
+    /// The FRONTIER strategy for arg = Id + F.
+    /// As arg contains the identity, the reached states only grow, and by linearity
+    /// arg(d1 + delta) = arg(d1) + arg(delta), where arg(d1) is already reached :
+    /// each iteration only applies arg to the states delta reached by the previous one.
+    GDDD
+    frontier_eval(const GDDD &d) const
+    {
+        GDDD d1 = d;
+        GDDD d2 = d;
+        GDDD delta = d;
+        do
+        {
+            d1 = d2;
+            delta = arg(delta) - d1;
+            d2 = d1 + delta;
+            if (! can_garbage && fobs::get_fixobserver ()->should_interrupt (d2, d1))
+            {
+              return d2;
+            }
+            if (can_garbage) {
+              if (fobs::get_fixobserver ()->should_interrupt (d2, d1))
+              {
+                fobs::get_fixobserver ()->update (d2, d1);
+                if (fobs::get_fixobserver ()->should_interrupt (d2, d1))
+                {
+                  return d2;
+                }
+              }
+              if (MemoryManager::should_garbage()) {
+                // ensure the reached states, the frontier and argument are preserved
+                d1.mark();
+                d2.mark();
+                delta.mark();
+                arg.mark();
+                Hom tt = Hom(this);
+                MemoryManager::garbage();
+              }
+            }
+        }
+        while (delta != GDDD::null);
+        return d2;
+    }
+
     GDDD
     eval(const GDDD &d) const
     {
@@ -1486,6 +1819,10 @@ public:
                 // into ( (G + Id) o (F + Id)* )* 
 	      Add* add = ((Add*)get_concret(arg));
 
+                if( add->get_have_id() && GHom::getFixpointStrategy() == GHom::FRONTIER )
+                {
+                    return frontier_eval(d);
+                }
                 if( add->get_have_id() )
                 {
 		    Add::partition partition = add->get_partition(variable);
@@ -1496,6 +1833,26 @@ public:
                     // operations that have to be applied at this level
                     // std::set<GHom> G = partition.second;
 
+                    // with DFS or a chaining saturation strategy, they are fired in turn
+                    std::vector<GHom> chain;
+                    if (GHom::getFixpointStrategy() == GHom::DFS || GHom::getSaturationStrategy() != GHom::ORDINARY) {
+                      std::vector<std::pair<int,GHom> > ordered;
+                      for (std::set<GHom>::const_iterator it = partition.second.begin() ; it != partition.second.end() ; ++it ) {
+                        ordered.push_back(std::make_pair(variable_order::lowest(*it), *it));
+                      }
+                      if (GHom::getSaturationStrategy() != GHom::ORDINARY) {
+                        std::sort(ordered.begin(), ordered.end(), variable_order());
+                      }
+                      for (size_t i = 0; i < ordered.size(); ++i) {
+                        if (GHom::getSaturationStrategy() == GHom::RECFIREANDSAT) {
+                          // saturate by (Id + F)* the states reached by the firing, as they are built
+                          chain.push_back(recFireSat(partition.first, ordered[i].second));
+                        } else {
+                          chain.push_back(ordered[i].second);
+                        }
+                      }
+                    }
+
                     do
                     {
                         d1 = d2;
@@ -1516,12 +1873,36 @@ public:
                         }
                       }
                         // Apply ( G + Id )
-                      std::set<GDDD> tmp;
-                      for (std::set<GHom>::const_iterator it = partition.second.begin() ; it != partition.second.end() ; ++it ) {
-                        tmp.insert ((*it) (d2));
+                      if (GHom::getFixpointStrategy() == GHom::DFS) {
+                        // saturate firings of each g \in G in turn, i.e. (\sum_i (g_i + id)\star) \star
+                        for (std::vector<GHom>::const_iterator it = chain.begin() ; it != chain.end() ; ++it ) {
+                          GDDD d3 = d2;
+                          do {
+                            d2 = d3;
+                            d3 = (*it) (d2) + d2;
+                          } while (d3 != d2);
+                        }
+                      } else if (GHom::getSaturationStrategy() != GHom::ORDINARY) {
+                        // chain the firings
+                        for (std::vector<GHom>::const_iterator it = chain.begin() ; it != chain.end() ; ++it ) {
+                          d2 = (*it) (d2) + d2;
+                        }
+                      } else {
+                        std::set<GDDD> tmp;
+#ifdef PARALLEL_DD
+                        if (partition.second.size() > 1) {
+                          std::vector<GHom> homs (partition.second.begin(), partition.second.end());
+                          std::vector<GDDD> images (homs.size(), d2);
+                          parallel_images(homs, images);
+                          tmp.insert (images.begin(), images.end());
+                        } else
+#endif // PARALLEL_DD
+                        for (std::set<GHom>::const_iterator it = partition.second.begin() ; it != partition.second.end() ; ++it ) {
+                          tmp.insert ((*it) (d2));
+                        }
+                        tmp.insert (d2);
+                        d2 = DED::add (tmp);
                       }
-                      tmp.insert (d2);
-                      d2 = DED::add (tmp);
                       
                       if (! can_garbage && fobs::get_fixobserver ()->should_interrupt (d2, d1))
                       {
@@ -1548,6 +1929,9 @@ public:
                           for (std::set<GHom>::const_iterator it = partition.second.begin() ; it != partition.second.end() ; ++it ) {
                             it->mark();
                           }
+                          for (std::vector<GHom>::const_iterator it = chain.begin() ; it != chain.end() ; ++it ) {
+                            it->mark();
+                          }
                           Hom tt = Hom(this);
                           //std::cerr << "garbage saturation" << std::endl;
                           MemoryManager::garbage();
@@ -1654,12 +2038,12 @@ _GHom::has_image_skip(const GDDD& d) const
       return d;
     }
     
-    for( GDDD::const_iterator it = d.begin() ; it != d.end() ; ++it )
+    for( GDDD::const_run_iterator it = d.runs_begin() ; it != d.runs_end() ; ++it )
       {
-	GDDD son = ghom.has_image(it->second);
+	GDDD son = ghom.has_image(it->son);
 	if( son != GDDD::null )
 	  {
-	    return GDDD(d.variable(), it->first, son) ;
+	    return GDDD(d.variable(), it->lo, son) ;
 	  }
       }
     return GDDD::null;
@@ -1691,20 +2075,40 @@ _GHom::eval_skip(const GDDD& d) const
       if (ghom == GHom::id) {
 	return d;
       }
-        GDDD::Valuation v;
-        for( GDDD::const_iterator it = d.begin() ; it != d.end() ; ++it )
+#ifdef PARALLEL_DD
+      // saturation : the sons are independent, compute their images in parallel
+      if (d.nbruns() > 1 && typeid(*this) == typeid(Fixpoint)) {
+        std::vector<GHom> homs (1, ghom);
+        std::vector<GDDD> sons;
+        sons.reserve(d.nbruns());
+        for( GDDD::const_run_iterator it = d.runs_begin() ; it != d.runs_end() ; ++it )
+          sons.push_back(it->son);
+        parallel_images(homs, sons);
+
+        GDDD::Builder v(d.variable());
+        size_t i = 0;
+        for( GDDD::const_run_iterator it = d.runs_begin() ; it != d.runs_end() ; ++it, ++i )
         {
-            GDDD son = ghom (it->second);
+            if( sons[i] != GDDD::null )
+            {
+                v.add(it->lo, it->hi, sons[i]);
+            }
+        }
+        return v.finalize();
+      }
+#endif // PARALLEL_DD
+        // the image of a run does not depend on its values
+        GDDD::Builder v(d.variable());
+        for( GDDD::const_run_iterator it = d.runs_begin() ; it != d.runs_end() ; ++it )
+        {
+            GDDD son = ghom (it->son);
             if( son != GDDD::null )
             {
-                v.push_back(std::make_pair(it->first, son));
+                v.add(it->lo, it->hi, son);
             }
         }
         
-        if( v.empty() )
-            return GDDD::null;
-        else
-            return GDDD(d.variable(),v);
+        return v.finalize();
     }
 
     return eval(d);
@@ -1796,6 +2200,15 @@ StrongHom::has_image(const GDDD &d) const
 }
 
 
+namespace {
+/// calls phi through the virtual table, see StaticStrongHom for direct calls
+struct virtual_phi {
+  const StrongHom & h;
+  explicit virtual_phi (const StrongHom & hh) : h(hh) {}
+  GHom operator() (int var, int val) const { return h.phi(var, val); }
+};
+}
+
 /* Eval */
 GDDD
 StrongHom::eval(const GDDD &d) const
@@ -1814,17 +2227,7 @@ StrongHom::eval(const GDDD &d) const
   }
   else
   {
-
-    int variable = d.variable();
-    std::set<GDDD> s;
-    GDDD::const_iterator dend = d.end();
-    for( GDDD::const_iterator vi = d.begin();
-         vi!=dend;
-         ++vi)
-    {
-        s.insert(phi(variable,vi->first)(vi->second));
-    }
-    return DED::add(s);
+    return d3::util::strong_eval(d, virtual_phi(*this), group_arcs());
   }
 }
 
@@ -1916,7 +2319,17 @@ HomCache::should_insert (const GHom & h) const
   return true;
 }
 
-static HomCache cache;
+static HomCache cache ("GHom cache");
+
+#ifdef PARALLEL_DD
+static std::pair<bool,GDDD>
+cached_image (const GHom & h, const GDDD & d)
+{
+  if (d == GDDD::null)
+    return std::make_pair(true, d);
+  return cache.contains(h, d);
+}
+#endif // PARALLEL_DD
 typedef Cache<GHom,GDDD,GDDD,char> ImgHomCache;
 
 template <>
@@ -1924,7 +2337,7 @@ GDDD ImgHomCache::eval(const GHom & func, const GDDD  & param) const {
   return _GHom::get_concret(func)->has_image_skip(param);
 }
 
-static ImgHomCache imgcache;
+static ImgHomCache imgcache ("GHom image cache");
 
 /* Eval */
 GDDD
@@ -1964,6 +2377,9 @@ GDDD GHom::eval(const GDDD &d) const{
 
 const GHom GHom::id(canonical( Identity(1)));
 
+GHom::fixpointStrategy GHom::fixpointStrategy_ = BFS;
+GHom::saturationStrategy GHom::saturationStrategy_ = ORDINARY;
+
 int GHom::refCounter() const{return concret->refCounter;}
 
 /* Sum */
@@ -2010,16 +2426,28 @@ void GHom::mark()const{
   }
 };
 
+bool GHom::is_marked()const{
+  return concret->marking;
+}
+
 void GHom::garbage(){
-  cache.clear();
-  imgcache.clear();
-  // mark phase
+  garbage_mark();
+  garbage_sweep();
+}
+
+void GHom::garbage_mark(){
   for(UniqueTable<_GHom>::Table::iterator di=canonical.table.begin();di!=canonical.table.end();++di){
     if((*di)->refCounter!=0){
       (*di)->marking=true;
       (*di)->mark();
     }
   }
+}
+
+void GHom::garbage_sweep(){
+  // keep the cached results over live homomorphisms and nodes
+  cache.sweep();
+  imgcache.sweep();
   // sweep phase
   for(UniqueTable<_GHom>::Table::iterator di=canonical.table.begin();di!=canonical.table.end();){
     if(!((*di)->marking)){
@@ -2039,43 +2467,67 @@ void GHom::garbage(){
 /*************************************************************************/
 /*                    Class Hom                                          */
 /*************************************************************************/
+// GHom::id is created with a reference, so references to it need not be counted :
+// default constructed and moved-from Hom leave its counter alone.
+void Hom::ref (const _GHom * h) {
+  if (h != id.concret)
+    h->refCounter++;
+}
+
+void Hom::deref (const _GHom * h) {
+  if (h != id.concret) {
+    assert(h->refCounter>0);
+    h->refCounter--;
+  }
+}
+
 /* Constructor */
 Hom::Hom(const Hom &h):GHom(h.concret){
-  concret->refCounter++;
+  ref(concret);
+}
+
+Hom::Hom(Hom &&h) noexcept :GHom(h.concret){
+  h.concret = id.concret;
 }
 
 Hom::Hom(const GHom &h):GHom(h.concret){
-  concret->refCounter++;
+  ref(concret);
 }
 
 Hom::Hom(const GDDD& d):GHom(d){
-  concret->refCounter++;
+  ref(concret);
 }
 
 Hom::Hom(int var, int val, const GHom &h):GHom(var,val,h){
-  concret->refCounter++;
+  ref(concret);
 }
 
 Hom::~Hom(){
-  assert(concret->refCounter>0);
-  concret->refCounter--;
+  deref(concret);
 }
 
 /* Set */
 
 Hom &Hom::operator=(const Hom &h){
-  assert(concret->refCounter>0);
-  concret->refCounter--;
-  concret=h.concret;
-  concret->refCounter++;
+  if (concret != h.concret) {
+    deref(concret);
+    concret=h.concret;
+    ref(concret);
+  }
   return *this;
 }
 
 Hom &Hom::operator=(const GHom &h){
-  assert(concret->refCounter>0);
-  concret->refCounter--;
-  concret=h.concret;
-  concret->refCounter++;
+  if (concret != h.concret) {
+    deref(concret);
+    concret=h.concret;
+    ref(concret);
+  }
+  return *this;
+}
+
+Hom &Hom::operator=(Hom &&h) noexcept {
+  std::swap(concret, h.concret);
   return *this;
 }
 
@@ -2439,9 +2891,15 @@ bool _GHom::operator< (const _GHom &h) const {
   return creation_counter > h.creation_counter;
 }
 
-void GHom::pstats(bool)
+void GHom::pstats(bool reinit)
 {
   std::cout << "*\nGHom Stats : size unicity table = " <<  canonical.size() << std::endl;
+  std::cout << "GHom cache entries kept/dropped by garbage collections : "
+	    << cache.kept() + imgcache.kept() << "/" << cache.dropped() + imgcache.dropped() << std::endl;
+  if (reinit) {
+    cache.reset_sweep_stats();
+    imgcache.reset_sweep_stats();
+  }
   
 #ifdef HASH_STAT
   std::cout << std::endl << "GHom Unicity table stats :" << std::endl;
@@ -248,7 +248,39 @@ public:
   /// are destroyed. This avoids maintaining reference counts during operation : only external references made through
   /// the DDD class are counted, and no recursive reference counting is needed.
   static void garbage(); 
+  /// The two phases of garbage(). Entries of the operation caches whose homomorphism, operand
+  /// and result all survive are kept by garbage_sweep(), so marking must be complete before it.
+  static void garbage_mark();
+  static void garbage_sweep();
+  /// For garbage collection internals. Between garbage_mark() and garbage_sweep(), whether this GHom survives.
+  bool is_marked() const;
   //@}
+
+  // strategies for fixpoint evaluation, as for GShom
+  // BFS = apply each g_i of the local part once, from the same states
+  // DFS = do each g_i to saturation then go to g_i+1
+  // FRONTIER = no saturation : the fixpoint of an union with the identity (Id + F)* is
+  //   computed from the top of the DDD, applying F to the newly reached states only
+  enum fixpointStrategy {BFS, DFS, FRONTIER};
+  // strategies for the local part G of a saturated fixpoint (Id + F + G)*
+  // ORDINARY = as the fixpoint strategy
+  // CHAINING = the g_i are applied in turn, each to the states reached by the previous ones,
+  //   in the order of the variables they affect, lowest first
+  // RECFIREANDSAT = as CHAINING, and the states reached by each firing of a g_i are saturated
+  //   by (Id + F)* while they are built : the firing recurses on the sons of a node, and only
+  //   the sub-DDD it produces are saturated, as sns::RecFireSat does for SDD
+  enum saturationStrategy {ORDINARY, CHAINING, RECFIREANDSAT};
+
+ private :
+  static fixpointStrategy fixpointStrategy_;
+  static saturationStrategy saturationStrategy_;
+
+ public :
+  static fixpointStrategy getFixpointStrategy() { return fixpointStrategy_; }
+  static void setFixpointStrategy(fixpointStrategy strat) { fixpointStrategy_ = strat; }
+
+  static saturationStrategy getSaturationStrategy() { return saturationStrategy_; }
+  static void setSaturationStrategy(saturationStrategy strat) { saturationStrategy_ = strat; }
 };
 
 
@@ -337,6 +369,9 @@ bool commutative (const GHom & h1, const GHom & h2);
 /// The only difference with Hom is that it implements reference counting
 /// so that instances of Hom are not collected upon MemoryManager::garbage().
 class Hom:public GHom /*, public DataSet*/ {
+  /// Reference counting of h, references to GHom::id are not counted.
+  static void ref (const _GHom * h);
+  static void deref (const _GHom * h);
  public:
   /* Constructor */
   /// \name Public Constructors.
@@ -346,6 +381,8 @@ class Hom:public GHom /*, public DataSet*/ {
   Hom(const GHom &h=GHom::id);
   /// Copy constructor. Maintains reference count.
   Hom(const Hom &h);
+  /// Move constructor, takes over the reference of h which is left equal to GHom::id.
+  Hom(Hom &&h) noexcept;
   /// Constructs a constant homomorphism. 
   Hom(const GDDD& d);   // constant
   /// Left concatenation of a single arc DDD. This is provided as a convenience
@@ -367,6 +404,8 @@ class Hom:public GHom /*, public DataSet*/ {
   Hom &operator=(const GHom &);
   /// Overloaded behavior for assignment operator, maintains reference counting.
   Hom &operator=(const Hom &);
+  /// Move assignment, exchanges the references held by the two Hom.
+  Hom &operator=(Hom &&) noexcept;
   //@}
 };
 
@@ -530,10 +569,17 @@ public:
   /// the terminal during it's evaluation, therefore default behavior returns GDDD::top
   virtual GDDD phiOne() const{return GDDD::top;}; 
   /// Evaluation over an arbitrary arc of a SDD. 
+  /// eval calls it once for each value of a run of arcs, so that a run [0,1e9] costs 1e9 calls.
   /// \param var the index of the variable labeling the node.
   /// \param val the value labeling the arc.
   /// \return a homomorphism to apply on the successor node  
   virtual GHom phi(int var,int val) const=0; 
+  /// Whether eval groups the arcs of a node by the homomorphism phi returns for them :
+  /// the sons of a group are united, then the homomorphism is applied once to their union.
+  /// This is cheaper when many arcs share a homomorphism, as for selectors.
+  /// Overload to return false in homomorphisms where phi returns distinct homomorphisms
+  /// for (almost) all arcs, grouping is then pure overhead.
+  virtual bool group_arcs() const { return true; }
   /// Comparator is pure virtual. Define a behavior in user homomorphisms.
   virtual bool operator==(const StrongHom &h) const=0;
   
@@ -552,6 +598,8 @@ public:
   /// Let an SDD d= (var, Union_i (val_i, d_i) )
   ///
   /// h (d) = Sum_i ( phi(var, val_i) (d_i) ) 
+  ///
+  /// computed as Sum_h ( h (Sum_{i | phi(var,val_i) = h} d_i) ) unless group_arcs() is false.
   GDDD eval(const GDDD &)const; 
 
   virtual GDDD has_image (const GDDD &) const;
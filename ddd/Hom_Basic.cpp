@@ -1,4 +1,5 @@
 #include "ddd/Hom_Basic.hh"
+#include "ddd/StaticStrongHom.hh"
 
 
 typedef enum comparator { EQ, NEQ, LT, GT, LEQ, GEQ} comparator;
@@ -43,7 +44,7 @@ static comparator negateComp(comparator comp) {
 }
 
 
-class _VarCompState:public StrongHom {
+class _VarCompState:public StaticStrongHom<_VarCompState> {
 
   int var;
   int val;
@@ -149,9 +150,8 @@ public:
     return _VarCompState(var, negateComp(comp) , val);
   }
   
-  size_t hash() const {
-    //return 8097*(var+2)^val * comp;
-    return ddd::wang32_hash( 8097 * ((var << 16) | (val << 8)) ^ (comp));
+  std::tuple<int,int,comparator> key() const {
+    return std::make_tuple(var, val, comp);
   }
   
   bool is_selector () const {
@@ -164,11 +164,6 @@ public:
     os << "[ " << DDD::getvarName(var) << " " << to_string(comp) << " " << val << " ]";
   }
 
-  bool operator==(const StrongHom &s) const {
-    _VarCompState* ps = (_VarCompState*)&s;
-    return comp == ps->comp && var == ps->var && val == ps->val;
-  }
-    _GHom * clone () const {  return new _VarCompState(*this); }
 };
 
 GHom varCompState (int var, comparator c , int val) {
@@ -202,7 +197,7 @@ GHom varGeqState (int var, int val) {
 
 
 
-class _setVarConst:public StrongHom {
+class _setVarConst:public StaticStrongHom<_setVarConst> {
 
   int var;
   int val;
@@ -241,25 +236,20 @@ public:
   }
 
   
-  size_t hash() const {
-    return 6619*(ddd::int32_hash(var) ^ ddd::int32_hash(val));
+  std::tuple<int,int> key() const {
+    return std::make_tuple(var, val);
   }
   void print (std::ostream & os) const {
     os << "[ " << DDD::getvarName(var) << " = "  << val << " ]";
   }
 
-  bool operator==(const StrongHom &s) const {
-    _setVarConst* ps = (_setVarConst*)&s;
-    return var == ps->var && val == ps->val;
-  }
-    _GHom * clone () const {  return new _setVarConst(*this); }
 };
 
 GHom setVarConst (int var, int val) {
   return _setVarConst(var,val);
 }
 
-class _incVar :public StrongHom {
+class _incVar :public StaticStrongHom<_incVar> {
   int target;
   int val;
 public:
@@ -285,7 +275,7 @@ public:
       bound = varGeqState( target, pot.begin()->first);
     } else {
       // max value
-      int max =  (pot.begin() + (pot.nbsons()-1))->first;
+      int max =  (pot.runs_end() - 1)->hi;
       bound = varLeqState( target, max );
     }
     return bound &  incVar(target, -val);
@@ -307,18 +297,9 @@ public:
     }
   }
   
-  size_t hash() const {
-    return 9049*(ddd::int32_hash(target) ^ ddd::int32_hash(val));
-//    return 9049* target^val;
+  std::tuple<int,int> key() const {
+    return std::make_tuple(target, val);
   }
-  
-  
-  bool operator==(const StrongHom &s) const {
-    _incVar* ps = (_incVar*)&s;
-    return target == ps->target && val == ps->val;
-  }
-
-  _GHom * clone () const {  return new _incVar(*this); }
 
   void print (std::ostream & os) const {
     os << "[ " << DDD::getvarName(target) << " += " << val << " ]";
@@ -350,7 +331,7 @@ static comparator invertComp(comparator comp) {
     }
 }
 
-class _VarCompVar : public StrongHom {	
+class _VarCompVar : public StaticStrongHom<_VarCompVar> {	
 	int var1;
 	int var2;
 	comparator c;
@@ -408,8 +389,8 @@ public:
 		return _GHom::compose(other);
 	}
 	
-	size_t hash() const {
-		return 6073*(var1+2)^var2 * c;
+	std::tuple<int,int,comparator> key() const {
+		return std::make_tuple(var1, var2, c);
 	}
 	
 	bool is_selector () const {
@@ -422,11 +403,6 @@ public:
 		os << "[ " << DDD::getvarName(var1) << to_string(c) << DDD::getvarName(var2) << " ]";
 	}
 	
-	bool operator==(const StrongHom &s) const {
-		_VarCompVar* ps = (_VarCompVar*)&s;
-		return var1 == ps->var1 && var2 == ps->var2 && c == ps->c;
-	}
-    _GHom * clone () const {  return new _VarCompVar(*this); }
 };
 
 GHom varCompVar (int var, comparator c , int var2) {
@@ -25,7 +25,7 @@
 
 
 // static initialization
-UniqueTable<std::vector<int> > IntDataSet::canonical = UniqueTable<std::vector<int> > ();
+UniqueTable<std::vector<int> > IntDataSet::canonical;
 
 const std::vector<int> * IntDataSet::empty_ = canonical(std::vector<int>(0));
 
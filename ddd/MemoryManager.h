@@ -31,6 +31,7 @@
 #include "ddd/SHom.h"
 #include "ddd/MLHom.h"
 #include "ddd/IntDataSet.h"
+#include "ddd/CacheBudget.hh"
 
 
 #include "ddd/process.hpp"
@@ -57,7 +58,7 @@ class MemoryManager{
 public:
   /* Mesure*/
   /// Returns the size of the unicity table for DDD.
-  static unsigned int nbDDD(){return GDDD::statistics();};
+  static size_t nbDDD(){return GDDD::statistics();};
   /// Returns the size of the cache unicity table for DDD. 
   static unsigned int nbDED(){return DED::statistics();};
   /// Returns the size of the unicity table for DDD Homomorphisms.
@@ -78,6 +79,9 @@ public:
 
   /// tester for memory management routine triggering in a top level fixpoint
     static bool should_garbage() {
+      // in REENTRANT builds, caches are only shrunk by garbage()
+      if (CacheBudget::exceeded())
+	return true;
       // trigger at rougly 5 million objects =1 Gig RAM
       //return nbDED() + nbSDED() + nbShom() + nbSDD() > 3000000;
       size_t mem = process::getResidentMemory();
@@ -96,23 +100,35 @@ public:
 
   /// Garbage collection function. 
   /// Call this to reclaim intermediate nodes, unused operations and related cache.
-  /// Note that this function is quite costly, and it totally destroys the cache
+  /// Everything reachable from referenced objects is marked first. Operation caches then keep the
+  /// entries whose operands and result are all marked, before unmarked objects are destroyed.
   static void garbage(){
     for (hooks_it it = hooks_.begin(); it != hooks_.end() ; ++it) {
       (*it)->preGarbageCollect();
     }
 
     MLHom::garbage();
+    // mark phase
+    // FIXME : if you dont use SDD suppress the following
+    GShom::garbage_mark();
+    GSDD::garbage_mark();
+    // END FIXME 
+    GHom::garbage_mark();
+    GDDD::garbage_mark();
+
+    // sweep phase, each cache is swept before the objects it refers to
     // FIXME : if you dont use SDD suppress the following
     SDED::garbage();
-    GShom::garbage();
-    GSDD::garbage();
+    GShom::garbage_sweep();
+    GSDD::garbage_sweep();
     // clear the IntDataSet
     IntDataSet::garbage();
     // END FIXME 
     DED::garbage();
-    GHom::garbage();
-    GDDD::garbage();
+    GHom::garbage_sweep();
+    GDDD::garbage_sweep();
+    // enforce the cache budget on the surviving entries
+    CacheBudget::reclaim();
 
     for (hooks_it it = hooks_.begin(); it != hooks_.end() ; ++it) {
       (*it)->postGarbageCollect();
@@ -132,12 +148,39 @@ public:
     DED::pstats(reinit);
     GHom::pstats(reinit);
     GDDD::pstats(reinit);    
+
+    CacheBudget::pstats(reinit);
   }
 
   static void setGCThreshold (size_t nbKbyte) {
     last_mem = nbKbyte;
   }
 
+  /// Sets the number of threads used by garbage() to mark and sweep DDD nodes.
+  /// Only effective in builds with parallel mode turned on.
+  static void setGCThreads (unsigned int nb_threads) {
+    GDDD::setGCThreads(nb_threads);
+  }
+
+  /// Bounds the memory used by the operation caches (DED, SDED, homomorphism caches, computed
+  /// table, nbStates caches) to nbBytes in total, 0 means unbounded (the default).
+  /// When the bound is reached each cache evicts entries following its policy, see CacheBudget.
+  /// The memory of an entry is estimated, nodes referenced by the entries are not counted.
+  static void setCacheBudget (size_t nbBytes) {
+    CacheBudget::setBudget(nbBytes);
+  }
+
+  /// Sets the eviction policy of all caches, CACHE_CLOCK by default.
+  static void setCachePolicy (CachePolicy policy) {
+    CacheBudget::setPolicy(policy);
+  }
+
+  /// Sets the eviction policy of a cache, given by its name in pstats().
+  /// Returns false if there is no such cache.
+  static bool setCachePolicy (const std::string & name, CachePolicy policy) {
+    return CacheBudget::setPolicy(name, policy);
+  }
+
   static size_t getPeakMemory () {
     should_garbage();
     return last_mem;
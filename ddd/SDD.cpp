@@ -28,7 +28,10 @@
 #include <map>
 #include <sstream>
 #include <cassert>
+#include <utility>
 #include <typeinfo>
+#include <limits>
+#include <stdexcept>
 
 #include "ddd/SDED.h"
 #include "ddd/SDD.h"
@@ -38,10 +41,12 @@
 #include "ddd/SHom.h"
 #include "ddd/util/hash_support.hh"
 #include "ddd/util/ext_hash_map.hh"
+#include "ddd/util/binary_stream.hh"
+#include "ddd/CacheBudget.hh"
 
 
 #ifdef REENTRANT
-#include "tbb/atomic.h"
+#include <atomic>
 #include "tbb/queuing_rw_mutex.h"
 #endif
 
@@ -73,7 +78,7 @@ public:
 			   ,height(-1)
 #endif 
 			   {}; 
-  _GSDD(int var,GSDD::Valuation val,int cpt=0):variable(var),valuation(val),_refCounter(2*cpt)
+  _GSDD(int var,GSDD::Valuation val,int cpt=0):variable(var),valuation(std::move(val)),_refCounter(2*cpt)
 #ifdef HEIGHTSDD
 			   ,height(-1)
 #endif 
@@ -100,6 +105,15 @@ public:
     }
   }
 
+  /// Takes over the arcs of g, and the ownership of their DataSet, see UniqueTable::find_or_move.
+  _GSDD (_GSDD &&g):variable(g.variable),valuation(std::move(g.valuation)),_refCounter(g._refCounter)
+#ifdef HEIGHTSDD
+			   ,height(g.height)
+#endif 
+			{
+    g.valuation.clear();
+  }
+
     _GSDD * clone () const { return new _GSDD(*this); }
 
   bool operator<(const _GSDD& g) const{
@@ -197,7 +211,7 @@ void mark_if_refd () const {
 // map<int,string> mapVarName;
 #ifdef REENTRANT
 
-static tbb::atomic<size_t> Max_SDD;
+static std::atomic<size_t> Max_SDD;
 class SDD_parallel_init
 {
 public:
@@ -333,7 +347,7 @@ GSDD::GSDD(const _GSDD &_g):concret(canonical(_g)){
 
 GSDD::GSDD(int variable,Valuation value){
   
-  concret= value.size() != 0 ?  canonical(_GSDD(variable,value)) : null.concret;
+  concret= value.size() != 0 ?  canonical.find_or_move(_GSDD(variable,std::move(value))) : null.concret;
 }
 
 
@@ -343,7 +357,7 @@ GSDD::GSDD(int var,const DataSet &val,const GSDD &d):concret(null.concret){ //va
     // cast to (DataSet*) to lose "const" type
     std::pair<DataSet *, GSDD> x( val.newcopy(),d);
     _g.valuation.push_back(x);
-    concret=canonical(_g);    
+    concret=canonical.find_or_move(std::move(_g));
   }
   //  concret->refCounter++;
 }
@@ -355,7 +369,7 @@ GSDD::GSDD(int var,const GSDD &va,const GSDD &d):concret(null.concret){ //var-va
     // cast to (DataSet*) to lose "const" type
     std::pair<DataSet *, GSDD> x( val.newcopy(),d);
     _g.valuation.push_back(x);
-    concret=canonical(_g);    
+    concret=canonical.find_or_move(std::move(_g));
   }
   //  concret->refCounter++;
 }
@@ -366,7 +380,7 @@ GSDD::GSDD(int var,const SDD &val,const GSDD &d):concret(null.concret){ //var-va
     // cast to (DataSet*) to lose "const" type
     std::pair<DataSet *, GSDD> x( val.newcopy(),d);
     _g.valuation.push_back(x);
-    concret=canonical(_g);    
+    concret=canonical.find_or_move(std::move(_g));
   }
   //  concret->refCounter++;
 }
@@ -457,8 +471,8 @@ private:
       if (sd3.find(g)==sd3.end()) {
 	sd3.insert(g);
 	d3res ++;
-	for(GDDD::const_iterator gi=g.begin();gi!=g.end();++gi)
-	  sddsize(gi->second);
+	for(GDDD::const_run_iterator gi=g.runs_begin();gi!=g.runs_end();++gi)
+	  sddsize(gi->son);
       }
   }
 
@@ -515,8 +529,17 @@ unsigned long int GSDD::size() const{
 class MySDDNbStates{
 private:
   int val; // val=0 donne nbState , val=1 donne noSharedSize
-  typedef ext_hash_map<GSDD,long double> cache_type;
+  typedef ext_hash_map<GSDD,Stamped<long double> > cache_type;
   static cache_type cache;
+
+  /// bounds the cache by the cache budget
+  class Budget : public BudgetedCache {
+  public:
+    Budget () : BudgetedCache ("SDD nbStates cache", sizeof(std::pair<const GSDD, Stamped<long double> >) + 2 * sizeof(void *)) {}
+    size_t size () const { return cache.size(); }
+    size_t evict (size_t target) { return CacheBudget::evict(cache, policy(), target, CacheBudget::no_release()); }
+  };
+  static Budget cache_budget;
 	
 long double nbStates(const GSDD& g)
 {
@@ -533,12 +556,15 @@ long double nbStates(const GSDD& g)
 	    for(GSDD::const_iterator gi=g.begin();gi!=g.end();++gi)
 	      res+=(gi->first->set_size())*nbStates(gi->second)+val;
 	    cache.insert(access,g);
-	    access->second = res;
+	    access->second.value = res;
+	    access->second.stamp = CacheBudget::tick();
+	    CacheBudget::inserted(cache_budget.entry_bytes());
 	    return res;
 	  } 
 		else 
 		{
-			return access->second;
+			access->second.stamp = CacheBudget::tick();
+			return access->second.value;
 		}
 	}
 }
@@ -556,7 +582,8 @@ public:
   }
 };
 
-ext_hash_map<GSDD,long double> MySDDNbStates::cache = ext_hash_map<GSDD,long double> ();
+MySDDNbStates::cache_type MySDDNbStates::cache;
+MySDDNbStates::Budget MySDDNbStates::cache_budget;
 
 long double GSDD::nbStates() const{
   static MySDDNbStates myNbStates(0);
@@ -565,17 +592,25 @@ long double GSDD::nbStates() const{
 
 
 void GSDD::garbage(){
+  garbage_mark();
+  garbage_sweep();
+}
+
+bool GSDD::is_marked() const{
+  return concret->is_marked();
+}
+
+void GSDD::garbage_mark(){
   if (canonical.size() > Max_SDD) 
     Max_SDD=canonical.size();  
 
   MySDDNbStates::clear();
-  // mark phase
   for(UniqueTable<_GSDD>::Table::iterator di=canonical.table.begin();di!=canonical.table.end();++di){
     (*di)->mark_if_refd();
   }
+}
 
-  
-
+void GSDD::garbage_sweep(){
   // sweep phase  
   for(UniqueTable<_GSDD>::Table::iterator di=canonical.table.begin();di!=canonical.table.end();){
     if(! (*di)->is_marked()){
@@ -604,47 +639,79 @@ void GSDD::garbage(){
 /*                   class SDD:public GSDD                                    */
 /******************************************************************************/
 
+// Terminals are created with a reference (see GSDD::one), so references to them need not be
+// counted : default constructed and moved-from SDD leave their counter alone.
+bool SDD::counted (const _GSDD * g) {
+  return g != GSDD::null.concret && g != GSDD::one.concret && g != GSDD::top.concret;
+}
+
+void SDD::ref (const _GSDD * g) {
+  if (counted(g))
+    g->ref();
+}
+
+void SDD::deref (const _GSDD * g) {
+  if (counted(g)) {
+    assert(g->refCounter()>0);
+    g->deref();
+  }
+}
+
 SDD::SDD(const SDD &g)
     : GSDD(g.concret)
 {
-    concret->ref();
+  ref(concret);
+}
+
+SDD::SDD(SDD &&g) noexcept
+    : GSDD(g.concret)
+{
+  g.concret = null.concret;
 }
 
 SDD::SDD(const GSDD &g):GSDD(g.concret){
-  concret->ref();
+  ref(concret);
 }
 
 
 SDD::SDD(int var,const DataSet& val,const GSDD &d):GSDD(var,val,d){
-  concret->ref();
+  ref(concret);
 }
 
 SDD::SDD(int var,const GSDD& val,const GSDD &d):GSDD(var,val,d){
-  concret->ref();
+  ref(concret);
 }
 
 SDD::SDD(int var,const SDD& val,const GSDD &d):GSDD(var, val,d){
-  concret->ref();
+  ref(concret);
 }
 
 
 SDD::~SDD(){
-  assert(concret->refCounter()>0);
-  concret->deref();
+  deref(concret);
 }
 
 
 SDD &SDD::operator=(const GSDD &g){
-  concret->deref();
-  concret=g.concret;
-  concret->ref();
+  if (concret != g.concret) {
+    deref(concret);
+    concret=g.concret;
+    ref(concret);
+  }
   return *this;
 }
 
 SDD &SDD::operator=(const SDD &g){
-  concret->deref();
-  concret=g.concret;
-  concret->ref();
+  if (concret != g.concret) {
+    deref(concret);
+    concret=g.concret;
+    ref(concret);
+  }
+  return *this;
+}
+
+SDD &SDD::operator=(SDD &&g) noexcept {
+  std::swap(concret, g.concret);
   return *this;
 }
 
@@ -701,3 +768,477 @@ size_t GSDD::set_hash() const {
   return size_t (concret);
 }
 
+
+
+/* Path enumeration */
+
+GSDD::path_iterator GSDD::paths_begin () const {
+  return path_iterator(*this);
+}
+
+GSDD::path_iterator GSDD::paths_end () const {
+  return path_iterator();
+}
+
+GSDD::path_iterator::path_iterator (const GSDD & g) : end_(false) {
+  if (! follow(to_sdd, g, GDDD(), NULL, -1))
+    advance();
+}
+
+bool GSDD::path_iterator::frame::operator== (const frame & f) const {
+  if (kind != f.kind)
+    return false;
+  switch (kind) {
+  case sdd_choice :
+    return arc == f.arc;
+  case ddd_choice :
+    return run == f.run && dval == f.dval;
+  default :
+    return val == f.val;
+  }
+}
+
+bool GSDD::path_iterator::follow (target_t target, GSDD s, GDDD d, const DataSet * value, int cont) {
+  for (;;) {
+    switch (target) {
+    case to_cont :
+      // the end of a path, or the son of an arc whose label is through
+      if (cont < 0)
+        return true;
+      s = pool_[cont].son;
+      cont = pool_[cont].next;
+      target = to_sdd;
+      break;
+    case to_sdd : {
+      if (s == GSDD::one) {
+        target = to_cont;
+        break;
+      }
+      if (s == GSDD::null || s == GSDD::top)
+        return false;
+      frame f;
+      f.kind = sdd_choice;
+      f.arc = s.begin();
+      f.arcs_end = s.end();
+      f.cont = cont;
+      f.pool_size = pool_.size();
+      f.depth = values_.size();
+      stack_.push_back(f);
+      continuation c = { f.arc->second, cont };
+      pool_.push_back(c);
+      cont = pool_.size() - 1;
+      value = f.arc->first;
+      target = to_value;
+      break;
+    }
+    case to_ddd : {
+      if (d == GDDD::one) {
+        target = to_cont;
+        break;
+      }
+      if (d == GDDD::null || d == GDDD::top)
+        return false;
+      frame f;
+      f.kind = ddd_choice;
+      f.run = d.runs_begin();
+      f.runs_end = d.runs_end();
+      f.dval = f.run->lo;
+      f.hi = f.run->hi;
+      f.son = f.run->son;
+      f.cont = cont;
+      f.pool_size = pool_.size();
+      f.depth = values_.size();
+      stack_.push_back(f);
+      values_.push_back(f.dval);
+      d = f.son;
+      break;
+    }
+    case to_value : {
+      const std::type_info & type = typeid(*value);
+      if (type == typeid(DDD)) {
+        d = * static_cast<const DDD *> (value);
+        target = to_ddd;
+      } else if (type == typeid(GSDD) || type == typeid(SDD)) {
+        s = * static_cast<const GSDD *> (value);
+        target = to_sdd;
+      } else if (type == typeid(IntDataSet)) {
+        const IntDataSet & set = * static_cast<const IntDataSet *> (value);
+        if (set.empty())
+          return false;
+        frame f;
+        f.kind = int_choice;
+        f.val = set.begin();
+        f.vals_end = set.end();
+        f.cont = cont;
+        f.pool_size = pool_.size();
+        f.depth = values_.size();
+        stack_.push_back(f);
+        values_.push_back(*f.val);
+        target = to_cont;
+      } else {
+        throw std::runtime_error(std::string("GSDD::path_iterator : unsupported type of arc value ") + type.name());
+      }
+      break;
+    }
+    }
+  }
+}
+
+void GSDD::path_iterator::advance () {
+  while (! stack_.empty()) {
+    frame & f = stack_.back();
+    // the continuations made after the choice are no longer pending
+    pool_.resize(f.pool_size);
+    bool found;
+    switch (f.kind) {
+    case ddd_choice :
+      if (f.dval < f.hi) {
+        values_.back() = ++f.dval;
+      } else if (++f.run != f.runs_end) {
+        f.dval = f.run->lo;
+        f.hi = f.run->hi;
+        f.son = f.run->son;
+        values_.back() = f.dval;
+      } else {
+        stack_.pop_back();
+        values_.pop_back();
+        continue;
+      }
+      found = follow(to_ddd, GSDD(), f.son, NULL, f.cont);
+      break;
+    case int_choice :
+      if (++f.val == f.vals_end) {
+        stack_.pop_back();
+        values_.pop_back();
+        continue;
+      }
+      values_.back() = *f.val;
+      found = follow(to_cont, GSDD(), GDDD(), NULL, f.cont);
+      break;
+    default :
+      if (++f.arc == f.arcs_end) {
+        stack_.pop_back();
+        continue;
+      }
+      {
+        continuation c = { f.arc->second, f.cont };
+        pool_.push_back(c);
+      }
+      found = follow(to_value, GSDD(), GDDD(), f.arc->first, pool_.size() - 1);
+      break;
+    }
+    if (found)
+      return;
+  }
+  end_ = true;
+}
+
+void GSDD::path_iterator::skip (size_t depth) {
+  // the choice of the value at depth is the last one kept
+  while (stack_.back().kind == sdd_choice || stack_.back().depth != depth)
+    stack_.pop_back();
+  values_.resize(depth + 1);
+  advance();
+}
+
+
+/* Serialization */
+
+namespace {
+  /// Magic number and version of the binary format of saveSDDBinary.
+  const char sdd_binary_magic[4] = { 'S', 'D', 'D', 'b' };
+  const unsigned char sdd_binary_version = 1;
+
+  /// The stream is a sequence of records, each introduced by its tag. A record of a node
+  /// (DDD, IntDataSet or SDD) numbers it in the table of its kind, arcs of SDD refer to their
+  /// values by the tag of their kind and their index in its table. The roots record ends the stream.
+  enum record_tag { roots_tag = 0, ddd_tag = 1, int_tag = 2, sdd_tag = 3 };
+
+  struct int_hash {
+    size_t operator() (const IntDataSet & s) const { return s.set_hash(); }
+  };
+  struct int_equal {
+    bool operator() (const IntDataSet & a, const IntDataSet & b) const { return a.set_equal(b); }
+  };
+
+  /// Numbers the SDD nodes, and the DDD nodes and IntDataSet referenced by their arcs, each in a
+  /// table of its own whose first entries are the terminals null, one and top (SDD and DDD).
+  /// The record of a node is written as soon as it is numbered, after the nodes it refers to,
+  /// so that the stream is produced and read in a single pass.
+  class binary_sdd_writer {
+    template <typename Key, typename Hash = d3::util::hash<Key>, typename Equal = d3::util::equal<Key> >
+    struct table {
+      typedef ext_hash_map<Key, unsigned long, Hash, Equal> index_t;
+      index_t index;
+      unsigned long size;
+
+      table () : size(0) {}
+
+      bool find (const Key & k, unsigned long & res) const {
+        typename index_t::const_accessor access;
+        if (! index.find(access, k))
+          return false;
+        res = access->second;
+        return true;
+      }
+      unsigned long number (const Key & k) {
+        typename index_t::accessor access;
+        index.insert(access, k);
+        access->second = size;
+        return size++;
+      }
+      /// how far back from the next node k is numbered, k should be numbered
+      uint64_t back (const Key & k) const {
+        unsigned long res = 0;
+        find(k, res);
+        return size - res;
+      }
+    };
+
+    /// son_back of the DDD format : the DDD being written is the next one in the table
+    class ddd_back {
+      const table<GDDD> & ddd_;
+    public:
+      explicit ddd_back (const table<GDDD> & ddd) : ddd_(ddd) {}
+      uint64_t operator() (const GDDD & son) const { return ddd_.back(son); }
+    };
+
+    d3::util::binary_writer & out_;
+    table<GDDD> ddd_;
+    table<IntDataSet, int_hash, int_equal> ints_;
+    table<GSDD> sdd_;
+
+    /// number g and the DDD nodes below it, depth first with an explicit stack
+    void add (const GDDD & g) {
+      unsigned long index;
+      if (ddd_.find(g, index))
+        return;
+      std::vector<std::pair<GDDD, GDDD::const_run_iterator> > stack;
+      stack.push_back(std::make_pair(g, g.runs_begin()));
+      while (! stack.empty()) {
+        std::pair<GDDD, GDDD::const_run_iterator> & top = stack.back();
+        if (top.second != top.first.runs_end()) {
+          GDDD son = top.second->son;
+          ++top.second;
+          if (! ddd_.find(son, index))
+            stack.push_back(std::make_pair(son, son.runs_begin()));
+        } else {
+          out_.byte(ddd_tag);
+          out_.svarint(top.first.variable());
+          d3::util::write_runs(out_, top.first, ddd_back (ddd_));
+          ddd_.number(top.first);
+          stack.pop_back();
+        }
+      }
+    }
+
+    void add (const IntDataSet & s) {
+      unsigned long index;
+      if (ints_.find(s, index))
+        return;
+      out_.byte(int_tag);
+      out_.varint(s.end() - s.begin());
+      // values are sorted, the first is followed by the gaps between them
+      for (IntDataSet::const_iterator it = s.begin(); it != s.end(); ++it) {
+        if (it == s.begin())
+          out_.svarint(*it);
+        else
+          out_.varint(int64_t (*it) - *(it - 1));
+      }
+      ints_.number(s);
+    }
+
+    /// number the value of an arc and the nodes below it, returns the tag of its kind
+    record_tag add (const DataSet * value) {
+      if (const GSDD * s = dynamic_cast<const GSDD *> (value)) {
+        add(*s);
+        return sdd_tag;
+      } else if (const DDD * d = dynamic_cast<const DDD *> (value)) {
+        add(*d);
+        return ddd_tag;
+      } else if (const IntDataSet * i = dynamic_cast<const IntDataSet *> (value)) {
+        add(*i);
+        return int_tag;
+      }
+      throw std::runtime_error(std::string("saveSDDBinary : unsupported type of arc value ") + typeid(*value).name());
+    }
+
+    uint64_t back (record_tag tag, const DataSet * value) const {
+      switch (tag) {
+      case sdd_tag :
+        return sdd_.back(* static_cast<const GSDD *> (value));
+      case ddd_tag :
+        return ddd_.back(* static_cast<const DDD *> (value));
+      default :
+        return ints_.back(* static_cast<const IntDataSet *> (value));
+      }
+    }
+
+  public:
+    explicit binary_sdd_writer (d3::util::binary_writer & out) : out_(out) {
+      ddd_.number(GDDD::null);
+      ddd_.number(GDDD::one);
+      ddd_.number(GDDD::top);
+      sdd_.number(GSDD::null);
+      sdd_.number(GSDD::one);
+      sdd_.number(GSDD::top);
+    }
+
+    /// number g and the nodes below it, depth first with an explicit stack. Values of arcs
+    /// are numbered with a stack of their own, so recursion is bounded by the depth of the hierarchy.
+    void add (const GSDD & g) {
+      unsigned long index;
+      if (sdd_.find(g, index))
+        return;
+      std::vector<std::pair<GSDD, GSDD::const_iterator> > stack;
+      stack.push_back(std::make_pair(g, g.begin()));
+      while (! stack.empty()) {
+        std::pair<GSDD, GSDD::const_iterator> & top = stack.back();
+        if (top.second != top.first.end()) {
+          add(top.second->first);
+          GSDD son = top.second->second;
+          ++top.second;
+          if (! sdd_.find(son, index))
+            stack.push_back(std::make_pair(son, son.begin()));
+        } else {
+          const GSDD & node = top.first;
+          out_.byte(sdd_tag);
+          out_.svarint(node.variable());
+          out_.varint(node.nbsons());
+          for (GSDD::const_iterator it = node.begin(); it != node.end(); ++it) {
+            record_tag tag = add(it->first);
+            out_.byte(tag);
+            out_.varint(back(tag, it->first));
+            out_.varint(sdd_.back(it->second));
+          }
+          sdd_.number(node);
+          stack.pop_back();
+        }
+      }
+    }
+
+    /// g should be numbered
+    unsigned long index (const GSDD & g) const {
+      unsigned long res = 0;
+      sdd_.find(g, res);
+      return res;
+    }
+  };
+}
+
+void saveSDDBinary(std::ostream& os, const std::vector<SDD>& list) {
+  d3::util::binary_writer out (os);
+  for (size_t i = 0; i < sizeof(sdd_binary_magic); ++i) {
+    out.byte(sdd_binary_magic[i]);
+  }
+  out.byte(sdd_binary_version);
+  binary_sdd_writer writer (out);
+  for (size_t i = 0; i < list.size(); ++i) {
+    writer.add(list[i]);
+  }
+  out.byte(roots_tag);
+  out.varint(list.size());
+  for (size_t i = 0; i < list.size(); ++i) {
+    out.varint(writer.index(list[i]));
+  }
+}
+
+void loadSDDBinary(std::istream& is, std::vector<SDD>& list) {
+  d3::util::binary_reader in (is, "loadSDDBinary");
+  for (size_t i = 0; i < sizeof(sdd_binary_magic); ++i) {
+    if (in.byte() != (unsigned char) sdd_binary_magic[i])
+      in.error("not a binary SDD stream");
+  }
+  if (in.byte() != sdd_binary_version)
+    in.error("unsupported version");
+
+  // the tables hold references, the nodes survive a garbage collection while loading
+  std::vector<DDD> ddd;
+  ddd.push_back(GDDD::null);
+  ddd.push_back(GDDD::one);
+  ddd.push_back(GDDD::top);
+  std::vector<IntDataSet> ints;
+  std::vector<SDD> sdd;
+  sdd.push_back(GSDD::null);
+  sdd.push_back(GSDD::one);
+  sdd.push_back(GSDD::top);
+  std::vector<std::pair<const DataSet *, GSDD> > arcs;
+  std::vector<int> values;
+
+  for (;;) {
+    switch (in.byte()) {
+    case ddd_tag : {
+      GDDD::Builder value ((int) in.svarint());
+      d3::util::read_runs(in, value, ddd);
+      ddd.push_back(value.finalize());
+      break;
+    }
+    case int_tag : {
+      uint64_t size = in.varint();
+      values.clear();
+      int64_t val = 0;
+      for (uint64_t k = 0; k < size; ++k) {
+        if (k == 0)
+          val = in.svarint();
+        else {
+          uint64_t gap = in.varint();
+          val = gap > (uint64_t) std::numeric_limits<int>::max() - val ? (int64_t) std::numeric_limits<int>::max() + 1 : val + (int64_t) gap;
+        }
+        if (val < std::numeric_limits<int>::min() || val > std::numeric_limits<int>::max())
+          in.error("value out of range");
+        values.push_back((int) val);
+      }
+      ints.push_back(IntDataSet(values));
+      break;
+    }
+    case sdd_tag : {
+      int var = (int) in.svarint();
+      uint64_t nbarcs = in.varint();
+      arcs.clear();
+      for (uint64_t k = 0; k < nbarcs; ++k) {
+        unsigned char tag = in.byte();
+        uint64_t back = in.varint();
+        const DataSet * value = NULL;
+        if (tag == ddd_tag && back != 0 && back <= ddd.size())
+          value = &ddd[ddd.size() - back];
+        else if (tag == int_tag && back != 0 && back <= ints.size())
+          value = &ints[ints.size() - back];
+        else if (tag == sdd_tag && back != 0 && back <= sdd.size())
+          value = &sdd[sdd.size() - back];
+        if (value == NULL)
+          in.error("bad arc value");
+        if (value->empty())
+          in.error("empty arc value");
+        // the son is numbered before the node, and is not null
+        back = in.varint();
+        if (back == 0 || back >= sdd.size())
+          in.error("bad son index");
+        arcs.push_back(std::make_pair(value, sdd[sdd.size() - back]));
+      }
+      if (arcs.empty())
+        in.error("node without arcs");
+      // the node owns copies of its values
+      GSDD::Valuation valuation;
+      valuation.reserve(arcs.size());
+      for (size_t k = 0; k < arcs.size(); ++k) {
+        valuation.push_back(std::make_pair(arcs[k].first->newcopy(), arcs[k].second));
+      }
+      sdd.push_back(GSDD(var, std::move(valuation)));
+      break;
+    }
+    case roots_tag : {
+      uint64_t nbroots = in.varint();
+      list.resize(nbroots);
+      for (uint64_t r = 0; r < nbroots; ++r) {
+        uint64_t index = in.varint();
+        if (index >= sdd.size())
+          in.error("bad root index");
+        list[r] = sdd[index];
+      }
+      return;
+    }
+    default :
+      in.error("unknown record");
+    }
+  }
+}
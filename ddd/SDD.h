@@ -25,10 +25,13 @@
 #define SDD_H
 
 
+#include <iosfwd>
 #include <string>
+#include <vector>
 
 #include "ddd/UniqueTable.h"
 #include "ddd/DataSet.h"
+#include "ddd/DDD.h"
 
 
 // #define HEIGHTSDD
@@ -85,6 +88,18 @@ public:
   /// returns a past the end iterator
   const_iterator end() const;
 
+  /// To enumerate the paths of a SDD lazily, flattening the values of nested arcs.
+  class path_iterator;
+  /// API for enumerating the paths of a SDD leading to one, without building them all.
+  /// A path is the sequence of the values met along it : an arc labeled by a DDD or SDD
+  /// contributes the values of a path of its label, an arc labeled by an IntDataSet one of its values.
+  ///
+  /// for (GSDD::path_iterator it = s.paths_begin() ; it != s.paths_end() ; ++it ) { // values (*it)[0..it->size()) }
+  ///
+  /// returns an iterator on the first path
+  path_iterator paths_begin() const;
+  /// returns a past the end path iterator
+  path_iterator paths_end() const;
   //@}
 
 
@@ -207,6 +222,11 @@ public:
   /// For garbage collection, do not call this directly, use MemoryManager::garbage() instead.
   /// \todo describe garbage collection algorithm(s) + mark usage homogeneously in one place.
   static void garbage();
+  /// The two phases of garbage(), MemoryManager::garbage() sweeps operation caches in between.
+  static void garbage_mark();
+  static void garbage_sweep();
+  /// For garbage collection internals. Between garbage_mark() and garbage_sweep(), whether this node survives.
+  bool is_marked() const;
   /// Prints some statistics to std::cout. Mostly used in debug and development phase.
   /// See also MemoryManager::pstats().
   /// \todo allow output in other place than cout. Clean up output.
@@ -253,6 +273,84 @@ public:
 };
 
 
+/// Enumerates the paths of a SDD to one, depth first with an explicit stack of the choices made :
+/// an arc of a SDD node, a run and value of a DDD node, or a value of an IntDataSet.
+/// Once the label of an arc is through, the path goes on with the son of the arc : the sons
+/// pending are kept in a pool of continuations, shared by the choices that lead to them.
+/// Dereferencing gives the values of the current path, in a buffer reused from a path to the
+/// next : stepping to the next path does not allocate once the buffers reach the depth of the SDD.
+/// Arcs labeled by other types of DataSet are not supported. Paths leading to top are not enumerated.
+class GSDD::path_iterator {
+  enum kind_t { sdd_choice, ddd_choice, int_choice };
+  /// a choice point of the path
+  struct frame {
+    kind_t kind;
+    /// the arc taken, for sdd_choice
+    GSDD::const_iterator arc;
+    GSDD::const_iterator arcs_end;
+    /// the run and value taken, for ddd_choice
+    GDDD::const_run_iterator run;
+    GDDD::const_run_iterator runs_end;
+    GDDD::wide_val_t dval;
+    GDDD::wide_val_t hi;
+    GDDD son;
+    /// the value taken, for int_choice
+    std::vector<int>::const_iterator val;
+    std::vector<int>::const_iterator vals_end;
+    /// what follows the choice : the continuation, and the size of the pool when it was made
+    int cont;
+    size_t pool_size;
+    /// the index in the path of the value chosen, for ddd_choice and int_choice
+    size_t depth;
+    bool operator== (const frame & f) const;
+  };
+  /// a son pending, followed by continuation next (-1 for none)
+  struct continuation {
+    GSDD son;
+    int next;
+  };
+  std::vector<frame> stack_;
+  std::vector<continuation> pool_;
+  std::vector<int> values_;
+  bool end_;
+
+  /// where to go on from : a SDD node, a DDD node, the label of an arc, or a continuation
+  enum target_t { to_sdd, to_ddd, to_value, to_cont };
+  /// follow the first choices from the target, returns true if they lead to the end of a path
+  bool follow (target_t target, GSDD s, GDDD d, const DataSet * value, int cont);
+  /// backtrack to the deepest choice with an alternative, and follow it
+  void advance ();
+
+public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef std::vector<int> value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const value_type * pointer;
+  typedef const value_type & reference;
+
+  /// a past the end iterator
+  path_iterator () : end_(true) {}
+  /// positioned on the first path of g
+  explicit path_iterator (const GSDD & g);
+
+  /// the values of the current path, valid until the iterator moves
+  reference operator* () const { return values_; }
+  pointer operator-> () const { return &values_; }
+
+  path_iterator & operator++ () { advance(); return *this; }
+  path_iterator operator++ (int) { path_iterator tmp = *this; advance(); return tmp; }
+
+  /// Skips the paths that make the same choices as the current path up to the value at depth
+  /// included. As paths through distinct arcs may share values, later paths may still start
+  /// with the same values. depth should be lower than the length of the current path.
+  void skip (size_t depth);
+
+  bool operator== (const path_iterator & o) const {
+    return end_ == o.end_ && (end_ || stack_ == o.stack_);
+  }
+  bool operator!= (const path_iterator & o) const { return ! (*this == o); }
+};
+
 /// Textual output of SDD into a stream in (relatively) human readable format.
 std::ostream& operator<<(std::ostream &,const GSDD &);
 /* Binary operators */
@@ -277,11 +375,17 @@ GSDD operator-(const GSDD&,const GSDD&); // difference
 /// Reference counting is enabled for SDD, so they will not be destroyed if they 
 /// are still in use upon garbage collection.
 class SDD:public GSDD {
+  /// Reference counting of g, references to terminals are not counted.
+  static bool counted (const _GSDD * g);
+  static void ref (const _GSDD * g);
+  static void deref (const _GSDD * g);
 public:
   /* Constructeur */
   /// Copy constructor. Constructs a copy, actual data (concret) is not copied.
   /// RefCounter is updated however.
   SDD(const SDD &);
+  /// Move constructor, takes over the reference of g which is left equal to GSDD::null.
+  SDD(SDD &&g) noexcept;
   /// Copy constructor from base class GDDD, also default DDD constructor to empty set. 
   /// Increments refCounter of g.concret.
   SDD(const GSDD &g=GSDD::null);
@@ -309,6 +413,8 @@ public:
   SDD &operator=(const GSDD&);
   /// Overloaded behavior for assignment operator, maintains reference counting.
   SDD &operator=(const SDD&);
+  /// Move assignment, exchanges the references held by the two SDD.
+  SDD &operator=(SDD &&) noexcept;
  //@}
 
 #ifdef EVDDD
@@ -320,6 +426,20 @@ public:
 
 };
 
+/// \name Binary serialization of SDD
+//@{
+/// Save a set of SDD in a compact binary stream. The SDD nodes, and the DDD nodes and IntDataSet
+/// labeling their arcs, are each numbered in a table of their own and written once, even when
+/// shared across levels of the hierarchy or between the SDD of list. A node is written as soon
+/// as the nodes it refers to are, in a single pass over the nodes.
+/// Throws std::runtime_error if an arc is labeled by another type of DataSet.
+void saveSDDBinary(std::ostream&, const std::vector<SDD>&);
+/// Load a set of SDD saved by saveSDDBinary, list is resized to the number of SDD saved.
+/// Nodes are built as the stream is read, and the stream is read up to the end of the save only.
+/// Throws std::runtime_error if the stream is truncated or is not in this format.
+void loadSDDBinary(std::istream&, std::vector<SDD>&);
+//@}
+
 /// Namespace declared to hide these functions. 
 /// It is not very nice to access unicity table directly, these functions were exposed to allow graphical dot export of the unicity table contents.
 namespace SDDutil {
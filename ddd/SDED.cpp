@@ -25,9 +25,11 @@
 #include <map>
 #include <typeinfo>
 #include <cassert>
+#include <utility>
 #include <iostream>
 
 #include "ddd/util/configuration.hh"
+#include "ddd/CacheBudget.hh"
 #include "ddd/DataSet.h"
 #include "ddd/DED.h"
 #include "ddd/SDD.h"
@@ -35,7 +37,7 @@
 #include "ddd/SHom.h"
 
 #ifdef REENTRANT
-# include "tbb/atomic.h"
+# include <atomic>
 #endif
 
 /******************************************************************************/
@@ -43,16 +45,35 @@
 namespace namespace_SDED {
 
   typedef hash_map< SDED,
-                    GSDD>::type Cache;
+                    Stamped<GSDD> >::type Cache;
   
   static Cache cache;
   static Cache recentCache;
+
+  /// bounds the cache by the cache budget, an entry also owns the operation its key points to
+  class SDEDCacheBudget : public BudgetedCache {
+    /// frees the key of an evicted entry
+    struct release_key {
+      void operator() (const std::pair<const SDED, Stamped<GSDD> > & e) const {
+        delete e.first.concret;
+      }
+    };
+  public:
+    SDEDCacheBudget () : BudgetedCache ("SDED cache", sizeof(std::pair<const SDED, Stamped<GSDD> >) + 6 * sizeof(void *)) {}
+    size_t size () const { return cache.size(); }
+    size_t evict (size_t target) {
+      SDED::peak();
+      return CacheBudget::evict(cache, policy(), target, release_key());
+    }
+  };
+
+  static SDEDCacheBudget cache_budget;
   
 #ifdef REENTRANT
 
-  static tbb::atomic<int> Hits;
-  static tbb::atomic<int> Misses;
-  static tbb::atomic<size_t> Max_SDED;
+  static std::atomic<int> Hits;
+  static std::atomic<int> Misses;
+  static std::atomic<size_t> Max_SDED;
   
   class SDED_parallel_init
   {
@@ -77,6 +98,10 @@ static size_t Max_SDED=0;
 
 #endif
 
+  // entries kept and dropped by garbage collections
+  static size_t Kept = 0;
+  static size_t Dropped = 0;
+
 } //namespace namespace_SDED 
 
 /******************************************************************************/
@@ -90,6 +115,7 @@ public:
     return (parameter==((_SDED_GSDD*)&e)->parameter);
   };
   _SDED * clone () const { return new _SDED_GSDD(*this); }
+  bool is_marked() const { return parameter.is_marked(); }
   GSDD eval() const{return parameter;};
 };
 
@@ -156,6 +182,13 @@ public:
   size_t hash() const;
   bool operator==(const _SDED &e)const;
   _SDED * clone () const { return new _SDED_Add(*this); }
+  bool is_marked() const {
+    for (parameters_it it = parameters.begin() ; it != parameters.end() ; ++it) {
+      if (! it->is_marked())
+	return false;
+    }
+    return true;
+  }
 
   /* Transform */
   GSDD eval() const;
@@ -331,7 +364,7 @@ GSDD _SDED_Add::eval() const{
   // return ret;
 
 
-  return GSDD(variable,value);
+  return GSDD(variable,std::move(value));
 };
 
 /* constructor*/
@@ -394,6 +427,7 @@ public:
   size_t hash() const;
   bool operator==(const _SDED &e)const;
   _SDED * clone () const { return new _SDED_Mult(*this); }
+  bool is_marked() const { return parameter1.is_marked() && parameter2.is_marked(); }
 
   /* Transform */
   GSDD eval() const;
@@ -462,7 +496,7 @@ GSDD _SDED_Mult::eval() const{
   for (std::map<GSDD,DataSet *>::iterator it =res.begin() ;it!= res.end();++it)
     value.push_back(std::make_pair(it->second,it->first));
   
-  return GSDD(variable,value);
+  return GSDD(variable,std::move(value));
 };
 
 /* constructor*/
@@ -495,6 +529,7 @@ public:
   size_t hash() const;
   bool operator==(const _SDED &e)const;
   _SDED * clone () const { return new _SDED_Minus(*this); }
+  bool is_marked() const { return parameter1.is_marked() && parameter2.is_marked(); }
   /* Transform */
   GSDD eval() const;
 
@@ -568,7 +603,7 @@ GSDD _SDED_Minus::eval() const{
   for (std::map<GSDD,DataSet *>::iterator it =res.begin() ;it!= res.end();++it)
     value.push_back(std::make_pair(it->second,it->first));
  
-  return GSDD(variable,value);
+  return GSDD(variable,std::move(value));
 };
 
 /* constructor*/
@@ -599,6 +634,7 @@ public:
   size_t hash() const;
   bool operator==(const _SDED &e)const;
   _SDED * clone () const { return new _SDED_Concat(*this); }
+  bool is_marked() const { return parameter1.is_marked() && parameter2.is_marked(); }
   /* Transform */
   GSDD eval() const;
 
@@ -639,7 +675,7 @@ GSDD _SDED_Concat::eval() const{
   for (std::map<GSDD,DataSet *>::iterator it =res.begin() ;it!= res.end();++it)
     value.push_back(std::make_pair(it->second,it->first));
  
-  return GSDD(variable,value);
+  return GSDD(variable,std::move(value));
 };
 
 /* constructor*/
@@ -669,6 +705,7 @@ public:
   size_t hash() const;
   bool operator==(const _SDED &e)const;
   _SDED * clone () const { return new _SDED_Shom(*this); }
+  bool is_marked() const { return shom.is_marked() && parameter.is_marked(); }
   /* Transform */
   GSDD eval() const;
 
@@ -716,10 +753,13 @@ void SDED::pstats(bool reinit)
   
   
   std::cout << "Cache hit ratio : " << double (namespace_SDED::Hits*100) / double(namespace_SDED::Misses+1+namespace_SDED::Hits) << "% ("<< namespace_SDED::Hits << "/" <<namespace_SDED::Misses << ")" << std::endl;
+  std::cout << "Cache entries kept/dropped by garbage collections : " << namespace_SDED::Kept << "/" << namespace_SDED::Dropped << std::endl;
   // long hitr=(Hits*100) / (Misses+1+Hits) ;
   if (reinit){
     namespace_SDED::Hits =0;
     namespace_SDED::Misses =0;  
+    namespace_SDED::Kept =0;
+    namespace_SDED::Dropped =0;
   }  
 
 }
@@ -738,21 +778,24 @@ void SDED::garbage(){
 		namespace_SDED::Max_SDED=namespace_SDED::cache.size();
 	}
 
-	std::vector<_SDED *> todel;
-	todel.reserve(namespace_SDED::cache.size());
-	for(namespace_SDED::Cache::iterator di=namespace_SDED::cache.begin();di!=namespace_SDED::cache.end();di++)
-	{
-	  todel.push_back(di->first.concret);
-	} 
-	namespace_SDED::cache.clear();
-	for (std::vector<_SDED *>::iterator it =todel.begin() ; it != todel.end() ; ++it) {
-	  delete *it;
-	}
+	// keep the entries whose operands and result survive, the others are dropped and their key freed
+	struct dead_entry {
+	  bool operator() (const std::pair<const SDED, Stamped<GSDD> > & e) const {
+	    if (e.first.concret->is_marked() && e.second.value.is_marked())
+	      return false;
+	    delete e.first.concret;
+	    return true;
+	  }
+	};
+	namespace_SDED::Dropped += namespace_SDED::cache.erase_if(dead_entry());
+	namespace_SDED::Kept += namespace_SDED::cache.size();
 }; 
 
 bool SDED::operator==(const SDED& e) const{
   if (concret == NULL)
     return e.concret==NULL;
+  if (e.concret == NULL)
+    return false;
   if(typeid(*concret)!=typeid(*(e.concret)))
     return false;
   else 
@@ -796,18 +839,21 @@ GSDD SDED::eval(){
           {
             namespace_SDED::Cache::accessor access;
             namespace_SDED::cache.insert(access,*this);
-            access->second = res;
+            access->second.value = res;
+            access->second.stamp = CacheBudget::tick();
           }
 
 
 	  concret=NULL;
+	  CacheBudget::inserted(namespace_SDED::cache_budget.entry_bytes());
 	  return res;
 	} else {
 	  // found in long term cache
 	  namespace_SDED::Hits++;
 	  delete concret;
 
-          return access->second;
+          access->second.stamp = CacheBudget::tick();
+          return access->second.value;
 	}
    } // end else : not a constant GSDD
 };
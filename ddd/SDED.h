@@ -34,10 +34,16 @@ class _SDED;
 class GSDD;
 class GShom;
         
+namespace namespace_SDED {
+  class SDEDCacheBudget;
+}
+
 /******************************************************************************/
 class SDED{
 private:
   _SDED *concret;
+  /// Bounds the cache by the cache budget, frees the keys it evicts.
+  friend class namespace_SDED::SDEDCacheBudget;
 
 public:
 	
@@ -55,6 +61,8 @@ public:
   static  unsigned int statistics();
   static void pstats(bool reinit=true);
   static size_t peak();
+  /// Drops the cache entries that refer to an object not marked by the collection in progress,
+  /// see MemoryManager::garbage().
   static void garbage(); 
   /// For storage in a hash table
   size_t hash () const ;
@@ -76,6 +84,8 @@ public:
   virtual size_t hash() const =0;
   virtual bool operator==(const _SDED &) const=0;
   virtual _SDED * clone () const =0;
+  /// For garbage collection : whether all the operands survive the collection in progress.
+  virtual bool is_marked() const =0;
   /* Transform */
 	virtual GSDD eval() const  = 0; 
 
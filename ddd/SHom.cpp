@@ -22,6 +22,7 @@
 
 #include <typeinfo>
 #include <cassert>
+#include <utility>
 #include <iostream>
 
 #include "ddd/MemoryManager.h"
@@ -308,7 +309,7 @@ namespace sns {
 	    for (std::map<GSDD,DataSet *>::iterator it =res.begin() ;it!= res.end();++it)
 	      value.push_back(std::make_pair(it->second,it->first));
 	    
-	    return GSDD(variable,value);
+	    return GSDD(variable,std::move(value));
 	    
 	  }
       return left(d)*right;
@@ -1877,6 +1878,57 @@ namespace sns {
 
 
     /* Eval */
+
+    /// The FRONTIER strategy for arg = Id + F.
+    /// As arg contains the identity, the reached states only grow, and by linearity
+    /// arg(d1 + delta) = arg(d1) + arg(delta), where arg(d1) is already reached :
+    /// each iteration only applies arg to the states delta reached by the previous one.
+    GSDD
+    frontier_eval(const GSDD &d) const
+    {
+      GSDD d1 = d;
+      GSDD d2 = d;
+      GSDD delta = d;
+      do
+	{
+	  d1 = d2;
+	  delta = arg(delta) - d1;
+	  d2 = d1 + delta;
+
+	  if (! can_garbage && fobs::get_fixobserver ()->should_interrupt (d2, d1))
+	    {
+	      return d2;
+	    }
+	  if (can_garbage) {
+	    /* Call the fixpoint Observer */
+	    if (sns::__fixpointObs != NULL){
+	      sns::__fixpointObs->update(d2,d1);
+	      if (sns::__fixpointObs->shouldInterrupt())
+		return d1;
+	    }
+	    if (fobs::get_fixobserver ()->should_interrupt (d2, d1))
+	      {
+		fobs::get_fixobserver ()->update (d2, d1);
+		if (fobs::get_fixobserver ()->should_interrupt (d2, d1))
+		  {
+		    return d2;
+		  }
+	      }
+	    if (MemoryManager::should_garbage()) {
+	      // ensure the reached states, the frontier and argument are preserved
+	      d1.mark();
+	      d2.mark();
+	      delta.mark();
+	      arg.mark();
+	      Shom tt = Shom(this);
+	      MemoryManager::garbage();
+	    }
+	  }
+	}
+      while (delta != GSDD::null);
+      return d2;
+    }
+
     GSDD 
     eval(const GSDD &d) const
     {
@@ -1902,6 +1954,10 @@ namespace sns {
 		
 	      // Rewrite ( Id + F + G )*
 	      // into ( O(Gn + Id) o (O(Fn + Id)*)* )* 
+	      if( add->get_have_id() && GShom::getFixpointStrategy() == GShom::FRONTIER )
+		{
+		  return frontier_eval(d);
+		}
 	      if( add->get_have_id() )
 		{                           
 		  Add::partition partition = add->get_partition(variable);
@@ -2574,7 +2630,7 @@ _GShom::eval_skip(const GSDD& d) const
         }
       else
 	{
-	  return GSDD(d.variable(),valuation);
+	  return GSDD(d.variable(),std::move(valuation));
 	}
       
     }
@@ -2659,10 +2715,36 @@ StrongShom::eval(const GSDD &d) const
       int variable=d.variable();
       d3::set<GSDD>::type s;
 
+      if (! group_arcs()) {
+        for(GSDD::const_iterator vi=d.begin();vi!=d.end();++vi)
+	  {
+	    s.insert(phi(variable,*vi->first) (vi->second) );
+	  }
+        return SDED::add(s);
+      }
+
+      // bucket the sons by the hom phi returns for their arc, except for arcs cut by
+      // the null constant, as selectors do
+      std::map<GShom, d3::set<GSDD>::type> buckets;
       for(GSDD::const_iterator vi=d.begin();vi!=d.end();++vi)
 	{
-	  s.insert(phi(variable,*vi->first) (vi->second) );
-    	}
+	  GShom h = phi(variable,*vi->first);
+	  if (h != Shom::null)
+	    buckets[h].insert(vi->second);
+	}
+      // by linearity, a hom applied once to the union of the sons of its bucket yields
+      // the union of their images
+      for (std::map<GShom, d3::set<GSDD>::type>::const_iterator it = buckets.begin(); it != buckets.end(); ++it)
+	{
+	  GSDD u = it->second.size() == 1 ? *it->second.begin() : SDED::add(it->second);
+	  if (u == GSDD::top) {
+	    // sons over different variables cannot be united, apply the hom to each of them
+	    for (d3::set<GSDD>::type::const_iterator si = it->second.begin(); si != it->second.end(); ++si)
+	      s.insert(it->first (*si));
+	  } else {
+	    s.insert(it->first (u));
+	  }
+	}
       return SDED::add(s);
     }
 }
@@ -2712,7 +2794,7 @@ ShomCache::should_insert (const GShom & h) const
   return true;
 }
 namespace sns {
-static ShomCache cache;
+static ShomCache cache ("GShom cache");
 }
 
 
@@ -2724,7 +2806,7 @@ GSDD ImgShomCache::eval(const GShom & func, const GSDD  & param) const {
 }
 
 namespace sns {
-static ImgShomCache imgcache;
+static ImgShomCache imgcache ("GShom image cache");
 }
 
 /* Eval */
@@ -2807,15 +2889,26 @@ void GShom::mark()const{
 // used to reduce Shom::add creation complexity in recursive cases
 typedef ext_hash_map<d3::set<GShom>::type,const _GShom*>::internal_hash_map  addCache_t;
 static addCache_t addCache;
+bool GShom::is_marked()const{
+  return concret->is_marked();
+}
+
 void GShom::garbage(){
-  addCache.clear();
-  sns::cache.clear();
-  sns::imgcache.clear();
-  
-  // mark phase
+  garbage_mark();
+  garbage_sweep();
+}
+
+void GShom::garbage_mark(){
   for(UniqueTable<_GShom>::Table::iterator di=canonical.table.begin();di!=canonical.table.end();++di){
       (*di)->mark_if_refd();
   }
+}
+
+void GShom::garbage_sweep(){
+  addCache.clear();
+  // keep the cached results over live homomorphisms and nodes
+  sns::cache.sweep();
+  sns::imgcache.sweep();
   // sweep phase
   for(UniqueTable<_GShom>::Table::iterator di=canonical.table.begin();di!=canonical.table.end();){
     if(!(*di)->is_marked()){
@@ -2835,43 +2928,67 @@ void GShom::garbage(){
 /*************************************************************************/
 /*                    Class Shom                                          */
 /*************************************************************************/
+// GShom::id is created with a reference, so references to it need not be counted :
+// default constructed and moved-from Shom leave its counter alone.
+void Shom::ref (const _GShom * h) {
+  if (h != id.concret)
+    h->ref();
+}
+
+void Shom::deref (const _GShom * h) {
+  if (h != id.concret) {
+    assert(h->refCounter()>0);
+    h->deref();
+  }
+}
+
 /* Constructor */
 Shom::Shom(const Shom &h):GShom(h.concret){
-  concret->ref();
+  ref(concret);
+}
+
+Shom::Shom(Shom &&h) noexcept :GShom(h.concret){
+  h.concret = id.concret;
 }
 
 Shom::Shom(const GShom &h):GShom(h.concret){
-  concret->ref();
+  ref(concret);
 }
 
 Shom::Shom(const GSDD& d):GShom(d){
-  concret->ref();
+  ref(concret);
 }
 
 Shom::Shom(int var,const DataSet &  val, const GShom &h):GShom(var,val,h){
-  concret->ref();
+  ref(concret);
 }
 
 Shom::~Shom(){
-  assert(concret->refCounter()>0);
-  concret->deref();
+  deref(concret);
 }
 
 /* Set */
 
 Shom &Shom::operator=(const Shom &h){
-  assert(concret->refCounter()>0);
-  concret->deref();
-  concret=h.concret;
-  concret->ref();
+  if (concret != h.concret) {
+    deref(concret);
+    concret=h.concret;
+    ref(concret);
+  }
   return *this;
 }
 
 Shom &Shom::operator=(const GShom &h){
-  assert(concret->refCounter()>0);
-  concret->deref();
-  concret=h.concret;
-  concret->ref();
+  if (concret != h.concret) {
+    deref(concret);
+    concret=h.concret;
+    ref(concret);
+  }
+  return *this;
+}
+
+Shom &Shom::operator=(Shom &&h) noexcept {
+  std::swap(concret, h.concret);
   return *this;
 }
 
@@ -3412,9 +3529,15 @@ GShom operator*(const GShom & h,const GShom & cond) {
 }
 
 
-void GShom::pstats(bool)
+void GShom::pstats(bool reinit)
 {
   std::cout << "*\nGSHom Stats : size unicity table = " <<  canonical.size() << std::endl;
+  std::cout << "GShom cache entries kept/dropped by garbage collections : "
+	    << sns::cache.kept() + sns::imgcache.kept() << "/" << sns::cache.dropped() + sns::imgcache.dropped() << std::endl;
+  if (reinit) {
+    sns::cache.reset_sweep_stats();
+    sns::imgcache.reset_sweep_stats();
+  }
 
   std::cout << "sizeof(_GShom):" << sizeof(_GShom) << std::endl; 
   std::cout << "sizeof(SIdentity):" << sizeof(sns::Identity) << std::endl; 
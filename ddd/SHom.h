@@ -203,12 +203,20 @@ public:
   /// MemoryManager::garbage() as order of calls (among GSDD::garbage(), GShom::garbage(), 
   /// SDED::garbage()) is important.
   static void garbage();
+  /// The two phases of garbage(). Entries of the operation caches whose homomorphism, operand
+  /// and result all survive are kept by garbage_sweep(), so marking must be complete before it.
+  static void garbage_mark();
+  static void garbage_sweep();
+  /// For garbage collection internals. Between garbage_mark() and garbage_sweep(), whether this GShom survives.
+  bool is_marked() const;
   //@}
 
   // strategies for fixpoint evaluation insaturation context
   // BFS = do each g_i once then go to g_i+1
   // DFS = do each g_i to saturation then go to g_i+1
-  enum fixpointStrategy {BFS, DFS};
+  // FRONTIER = no saturation : the fixpoint of an union with the identity (Id + F)* is
+  //   computed from the top of the SDD, applying F to the newly reached states only
+  enum fixpointStrategy {BFS, DFS, FRONTIER};
   enum saturationStrategy {ORDINARY, RECFIREANDSAT};
 
  private : 
@@ -322,6 +330,9 @@ GShom apply2k (const GSDD &);
 /// so that instances of Shom are not collected upon MemoryManager::garbage().
 class Shom : public GShom 
 {
+  /// Reference counting of h, references to GShom::id are not counted.
+  static void ref (const _GShom * h);
+  static void deref (const _GShom * h);
 public:
   /// \name Public Constructors.
   /// Default constructor builds identity homomorphism.
@@ -330,6 +341,8 @@ public:
   Shom(const GShom &h=GShom::id);
   /// Copy constructor. Maintains reference count.
   Shom(const Shom &h);
+  /// Move constructor, takes over the reference of h which is left equal to GShom::id.
+  Shom(Shom &&h) noexcept;
   /// Constructs a constant homomorphism. 
   Shom(const GSDD& d);  
   /// Left concatenation of a single arc SDD. This is provided as a convenience
@@ -354,6 +367,8 @@ public:
   Shom &operator=(const GShom &);
   /// Overloaded behavior for assignment operator, maintains reference counting.
   Shom &operator=(const Shom &);
+  /// Move assignment, exchanges the references held by the two Shom.
+  Shom &operator=(Shom &&) noexcept;
   //@}
 };
 
@@ -557,6 +572,11 @@ public:
   /// \param val the set of values labeling the arc.
   /// \return a homomorphism to apply on the successor node
   virtual GShom phi(int var,const DataSet& val) const=0;
+  /// Whether eval groups the arcs of a node by the homomorphism phi returns for them :
+  /// the sons of a group are united, then the homomorphism is applied once to their union.
+  /// Overload to return false in homomorphisms where phi returns distinct homomorphisms
+  /// for (almost) all arcs.
+  virtual bool group_arcs() const { return true; }
   /// Comparator is pure virtual. Define a behavior in user homomorphisms.
   virtual bool operator==(const StrongShom &h) const=0;
   /// Comparator for unicity table. Users should not use this. The behavior is 
@@ -573,6 +593,8 @@ public:
   /// Let an SDD d= (var, Union_i (val_i, d_i) )
   ///
   /// h (d) = Sum_i ( phi(var, val_i) (d_i) ) 
+  ///
+  /// computed as Sum_h ( h (Sum_{i | phi(var,val_i) = h} d_i) ) unless group_arcs() is false.
   GSDD eval(const GSDD &)const;  
 
   virtual GSDD has_image (const GSDD & d) const ;
@@ -0,0 +1,191 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/* -*- C++ -*- */
+#ifndef STATIC_STRONG_HOM_HH
+#define STATIC_STRONG_HOM_HH
+
+#include <map>
+#include <tuple>
+#include <typeinfo>
+#include <type_traits>
+#include <vector>
+
+#include "ddd/DDD.h"
+#include "ddd/DED.h"
+#include "ddd/Hom.h"
+#include "ddd/hashfunc.hh"
+
+namespace d3 { namespace util {
+
+/// The evaluation of strong homomorphisms, see StrongHom::eval.
+/// phi(var,val) is called through the functor phi, so that it may be inlined.
+/// It is called for each value of a run : the cost grows with the width of runs, not their number.
+/// Unless group is false, the arcs are grouped by the homomorphism phi returns for them.
+template <typename Phi>
+GDDD strong_eval (const GDDD & d, const Phi & phi, bool group)
+{
+  int variable = d.variable();
+  // the images of the arcs need not be single arcs over variable : they are summed
+  std::vector<GDDD> s;
+  s.reserve(d.nbruns());
+  // when grouping, the sons of the arcs are bucketed by the hom phi returns for them,
+  // except for arcs cut by the null constant, as selectors do
+  const GHom null_hom (GDDD::null);
+  std::map<GHom,size_t> buckets;
+  std::vector<GHom> homs;
+  std::vector<std::vector<GDDD> > sons;
+  GDDD::const_run_iterator dend = d.runs_end();
+  for (GDDD::const_run_iterator vi = d.runs_begin(); vi != dend; ++vi) {
+    // the values of a run share their son : consecutive values mapped to the same hom
+    // have the same image
+    GHom h = phi(variable, vi->lo);
+    for (GDDD::wide_val_t val = vi->lo; val <= vi->hi; ++val) {
+      if (val != vi->lo) {
+        GHom next = phi(variable, val);
+        if (next == h)
+          continue;
+        h = next;
+      }
+      if (! group) {
+        s.push_back(h(vi->son));
+        continue;
+      }
+      if (h == null_hom)
+        continue;
+      std::pair<std::map<GHom,size_t>::iterator,bool> ins = buckets.insert(std::make_pair(h, homs.size()));
+      if (ins.second) {
+        homs.push_back(h);
+        sons.push_back(std::vector<GDDD>());
+      }
+      sons[ins.first->second].push_back(vi->son);
+    }
+  }
+  // by linearity, a hom applied once to the union of the sons of its bucket yields the
+  // union of their images
+  for (size_t b = 0; b < homs.size(); ++b) {
+    GDDD u = sons[b].size() == 1 ? sons[b].front() : DED::add(sons[b]);
+    if (u == GDDD::top) {
+      // sons over different variables cannot be united, apply the hom to each of them
+      for (std::vector<GDDD>::const_iterator it = sons[b].begin(); it != sons[b].end(); ++it)
+        s.push_back(homs[b](*it));
+    } else {
+      s.push_back(homs[b](u));
+    }
+  }
+  return DED::add(s);
+}
+
+/// hash of a member of the key of a StaticStrongHom : integers and enums are mixed,
+/// other types provide size_t hash() const, as GDDD and GHom do
+template <typename T>
+size_t key_hash (const T & t, std::true_type)
+{
+  return ddd::wang32_hash((size_t) t);
+}
+
+template <typename T>
+size_t key_hash (const T & t, std::false_type)
+{
+  return t.hash();
+}
+
+template <size_t I, typename Tuple>
+struct tuple_hash {
+  static size_t hash (const Tuple & t) {
+    typedef typename std::tuple_element<I - 1, Tuple>::type elem_t;
+    typedef std::integral_constant<bool, std::is_integral<elem_t>::value || std::is_enum<elem_t>::value> is_scalar;
+    return tuple_hash<I - 1, Tuple>::hash(t) * 10007 ^ key_hash(std::get<I - 1>(t), is_scalar());
+  }
+};
+
+template <typename Tuple>
+struct tuple_hash<0, Tuple> {
+  static size_t hash (const Tuple &) {
+    return 0;
+  }
+};
+
+}} // namespace d3::util
+
+/// Base class of user strong homomorphisms whose behavior is known at compile time,
+/// using the curiously recurring template pattern : class H : public StaticStrongHom<H>.
+///
+/// Derived provides :
+///  - GHom phi(int var, int val) const, called directly by eval rather than through
+///    the virtual table, so that it may be inlined,
+///  - GDDD phiOne() const, if the terminal may be met,
+///  - key() const, returning a std::tuple of the members that identify the homomorphism,
+///    e.g. std::make_tuple(var, val). Members are integers, enums, or types with
+///    size_t hash() const and operator== such as GDDD and GHom.
+///
+/// Equality, hashing and cloning are generated from key() and the copy constructor of
+/// Derived. Instances are canonized into GHom as any StrongHom, and may still overload the
+/// other virtual functions of _GHom (skip_variable, get_range, compose, invert...).
+///
+/// Only the calls to phi and phiOne within eval are resolved at compile time : operator==,
+/// hash, clone and eval itself remain virtual functions of _GHom, called through the unicity
+/// table and the cache. Evaluation is dominated by the DDD operations, demo/bench/strong_bench
+/// shows no measurable gain over a StrongHom.
+template <typename Derived>
+class StaticStrongHom : public StrongHom {
+  const Derived & self () const { return static_cast<const Derived &>(*this); }
+
+  /// calls Derived::phi without virtual dispatch
+  struct static_phi {
+    const Derived & h;
+    explicit static_phi (const Derived & hh) : h(hh) {}
+    GHom operator() (int var, int val) const { return h.Derived::phi(var, val); }
+  };
+
+public:
+  /// StrongHom::operator==(const _GHom &) has checked that s is also a Derived
+  bool operator== (const StrongHom & s) const {
+    return self().key() == static_cast<const Derived &>(s).key();
+  }
+
+  size_t hash () const {
+    typedef decltype(self().key()) key_t;
+    // distinguishes homomorphisms of different types with equal keys
+    static const size_t seed = typeid(Derived).hash_code();
+    return seed ^ d3::util::tuple_hash<std::tuple_size<key_t>::value, key_t>::hash(self().key());
+  }
+
+  _GHom * clone () const {
+    return new Derived(self());
+  }
+
+  /// The same evaluation as StrongHom::eval, with direct calls to Derived::phi and phiOne
+  GDDD eval (const GDDD & d) const {
+    if (d == GDDD::null) {
+      return GDDD::null;
+    } else if (d == GDDD::one) {
+      return self().Derived::phiOne();
+    } else if (d == GDDD::top) {
+      return GDDD::top;
+    } else {
+      return d3::util::strong_eval(d, static_phi(self()), self().group_arcs());
+    }
+  }
+};
+
+#endif /* STATIC_STRONG_HOM_HH */
@@ -25,38 +25,66 @@
 #define UNIQUETABLE_H
 
 #include <cassert>
+#include <utility>
 #include <vector>
 #include "ddd/util/hash_support.hh"
 #include "ddd/util/hash_set.hh"
 
 
 #ifdef REENTRANT
-#include "tbb/queuing_mutex.h"
-#include "tbb/mutex.h"
+#include "ddd/util/concurrent_hash_set.hh"
 #endif
 
 
 
 /// This class implements a unicity table mechanism, based on an STL hash_set.
 /// Requirements on the contained type are thus those of hash_set.
+/// In REENTRANT builds, the table is a d3::concurrent_hash_set : lookups are lock free and
+/// concurrent insertions of distinct values do not serialize.
 template<typename T>
 class UniqueTable{
 
-private:
-	
 #ifdef REENTRANT
-  // typedef tbb::queuing_mutex table_mutex_t;
-  typedef tbb::mutex table_mutex_t;
-  table_mutex_t table_mutex_;
+  /// reserved slot values of the concurrent table
+  struct slot_traits {
+    static const T* empty () { return NULL; }
+    static const T* erased () { return (const T*) 1; }
+  };
+
+  /// the key of a lookup, compared to stored values
+  struct key_equal {
+    const T * key;
+    bool operator() (const T * stored) const { return d3::util::equal<const T*>() (stored, key); }
+  };
+
+  /// builds the stored copy of the key on a miss
+  struct key_clone {
+    const T * key;
+    const T * operator() () const { return unique::clone<T>() (*key); }
+  };
+
+  /// find_or_move : compares to the key, or to the value it was moved to once built
+  struct moved_key_equal {
+    const T * const * key;
+    bool operator() (const T * stored) const { return d3::util::equal<const T*>() (stored, *key); }
+  };
+
+  /// find_or_move : builds the stored value by moving the key on a miss
+  struct key_move {
+    T * key;
+    const T ** moved;
+    const T * operator() () const { return *moved = new T (std::move (*key)); }
+  };
+
+  /// frees the copy of a thread that lost an insertion race
+  struct clone_destroy {
+    void operator() (const T * clone) const { unique::destroy<T>() (clone); }
+  };
 #endif
 
 public:
   /// Constructor, builds a default table.
   UniqueTable()
-#ifdef REENTRANT
-    :
-    table_mutex_()
-#endif
   {
 #ifndef REENTRANT
 #ifndef USE_STD_HASH
@@ -66,9 +94,6 @@ public:
   }
 
   UniqueTable(size_t s):
-#ifdef REENTRANT
-    table_mutex_(),
-#endif
   table (s)
   {
 #ifndef REENTRANT
@@ -79,7 +104,11 @@ public:
   }
 
   /// Typedef helps hide implementation type (currently gnu gcc's hash_set).
+#ifdef REENTRANT
+  typedef d3::concurrent_hash_set<const T*, slot_traits, d3::util::hash<const T*> > Table;
+#else
     typedef typename d3::hash_set<const T*>::type  Table;
+#endif
   /// The actual table, operations on the UniqueTable are delegated on this.
   Table table; // Unique table of GDDD
 
@@ -92,9 +121,10 @@ public:
     operator()(const T &_g)
   {
 #ifdef REENTRANT
-    table_mutex_t::scoped_lock lock(table_mutex_);
-#endif
-
+    key_equal eq = { &_g };
+    key_clone make = { &_g };
+    return table.find_or_insert (d3::util::hash<const T*>() (&_g), eq, make, clone_destroy()).first;
+#else
     typename Table::const_iterator it = table.find(&_g); 
     if (it != table.end() ) {
       return *it;
@@ -105,6 +135,32 @@ public:
       ((void)ref);   
       return clone;
     }
+#endif
+  }
+
+  /// As operator(), but on a miss the stored value is move constructed from _g instead of
+  /// cloned, which saves copying its contents. _g is left in a moved-from state.
+  /// Unlike clone, this does not preserve a derived type : the dynamic type of _g must be T.
+  const T*
+    find_or_move(T &&_g)
+  {
+#ifdef REENTRANT
+    const T * key = &_g;
+    moved_key_equal eq = { &key };
+    key_move make = { &_g, &key };
+    return table.find_or_insert (d3::util::hash<const T*>() (&_g), eq, make, clone_destroy()).first;
+#else
+    typename Table::const_iterator it = table.find(&_g);
+    if (it != table.end() ) {
+      return *it;
+    } else {
+      T * moved = new T (std::move (_g));
+      std::pair<typename Table::iterator, bool> ref=table.insert(moved);
+      assert(ref.second);
+      ((void)ref);
+      return moved;
+    }
+#endif
   }
 
   /// Returns the current number of filled entries in the table.
@@ -25,11 +25,27 @@
 #define UNIQUETABLE_ID_H
 
 #include <cassert>
+#include <chrono>
 #include <vector>
 #include "ddd/util/configuration.hh"
 #include "ddd/util/hash_support.hh"
 #include "ddd/util/hash_set.hh"
 
+#ifdef REENTRANT
+#include <algorithm>
+#include <atomic>
+#include "tbb/spin_mutex.h"
+#include "ddd/util/concurrent_hash_set.hh"
+#endif
+
+#ifdef PARALLEL_DD
+#include "tbb/blocked_range.h"
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+#include "ddd/util/atomic_bitset.hh"
+#endif
+
 // the clone contract
 
 /// Requirements on the contained type are to be cloneable, 
@@ -48,10 +64,15 @@
 // Additional contract requirements for the stored type T :
 // it should be cloneable. Implement clone in class C by :
 // return new C(*this);
+// If clone does not use a plain new, specialize unique::destroy<C> accordingly.
 
 
 
 /// This class implements a unique table mechanism, based on a hash.
+/// Garbage collection is generational, see garbage(). In PARALLEL_DD builds, it may use
+/// several threads, see set_gc_threads().
+/// In REENTRANT builds, the hash table is a d3::concurrent_hash_set, the index table
+/// is segmented so that it never moves, and ids are handed out to threads in batches.
 template<typename T, typename ID>
 class UniqueTableId {
   typedef ID id_t;
@@ -72,42 +93,503 @@ class UniqueTableId {
   struct id_compare {
     bool operator()(const id_t & id1,const id_t & id2) const{
       if (id1==0 || id2 == 0) {
-	// deleted key
-	return false;
+	// deleted key, must compare equal to itself for erase to work
+	return id1 == id2;
       }
       return * UniqueTableId::instance().resolve(id1) == * UniqueTableId::instance().resolve(id2);
     }
   };
 
 
+#ifdef REENTRANT
+  /// ids 0 and 1 are never allocated, they mark free and erased slots of the table
+  struct id_traits {
+    static id_t empty () { return 0; }
+    static id_t erased () { return 1; }
+  };
+
+  /// the key of a lookup, compared to the objects designated by stored ids
+  struct key_equal {
+    const T * key;
+    bool operator() (const id_t & id) const { return * UniqueTableId::instance().resolve(id) == *key; }
+  };
+
+  /// on a miss, store a copy of the key under a new id
+  struct key_clone {
+    const T * key;
+    id_t operator() () const {
+      UniqueTableId & ut = UniqueTableId::instance();
+      id_t id = ut.next_id();
+      ut.set_index(id, unique::clone<T>() (*key));
+      return id;
+    }
+  };
+
+  /// undo key_clone, for the thread that lost an insertion race
+  struct clone_destroy {
+    void operator() (const id_t & id) const {
+      UniqueTableId & ut = UniqueTableId::instance();
+      unique::destroy<T>() (ut.resolve(id));
+      ut.set_index(id, NULL);
+      ut.release_id(id);
+    }
+  };
+
+  typedef d3::concurrent_hash_set<id_t, id_traits, id_hash> table_t;
+
+  /// The index is made of segments that are allocated as needed and never move,
+  /// so that resolve does not need to lock. Segment 0 holds ids [0,first_segment_size),
+  /// segment s > 0 holds ids [first_segment_size << (s-1), first_segment_size << s).
+  static const int first_segment_log = 12;
+  static const size_t first_segment_size = 1 << first_segment_log;
+  static const int nb_segments = 8 * sizeof(id_t) - first_segment_log + 1;
+
+  static int segment_of (size_t id) {
+    if (id < first_segment_size) {
+      return 0;
+    }
+    return 8 * sizeof(unsigned long) - __builtin_clzl (id >> first_segment_log);
+  }
+  static size_t segment_start (int seg) {
+    return seg == 0 ? 0 : first_segment_size << (seg - 1);
+  }
+  static size_t segment_size (int seg) {
+    return seg == 0 ? first_segment_size : first_segment_size << (seg - 1);
+  }
+
+  std::atomic<const T**> segments[nb_segments];
+  /// The reference counts, segmented as the index.
+  std::atomic<std::atomic<id_t>*> ref_segments[nb_segments];
+
+  const T* & index_slot (size_t id) const {
+    int seg = segment_of(id);
+    return segments[seg].load(std::memory_order_acquire) [id - segment_start(seg)];
+  }
+
+  std::atomic<id_t> & ref_slot (size_t id) const {
+    int seg = segment_of(id);
+    return ref_segments[seg].load(std::memory_order_acquire) [id - segment_start(seg)];
+  }
+
+  void set_index (const id_t & id, const T* value) {
+    index_slot(id) = value;
+  }
+
+  /// number of ids taken by a thread at once
+  static const size_t id_batch_size = 64;
+
+  /// protects fresh_id, free_ids and segment allocation
+  typedef tbb::spin_mutex alloc_mutex_t;
+  alloc_mutex_t alloc_mutex;
+  /// ids >= fresh_id have never been used
+  size_t fresh_id;
+  /// ids recycled by garbage, taken before fresh ones
+  std::vector<id_t> free_ids;
+  /// protects roots
+  typedef tbb::spin_mutex roots_mutex_t;
+  roots_mutex_t roots_mutex;
+
+  /// the ids owned by the calling thread, not yet used
+  static std::vector<id_t> & local_ids () {
+    static thread_local std::vector<id_t> ids;
+    return ids;
+  }
+
+  /// refill the batch of the calling thread
+  void fill_batch (std::vector<id_t> & batch) {
+    alloc_mutex_t::scoped_lock lock(alloc_mutex);
+    while (batch.size() < id_batch_size && ! free_ids.empty()) {
+      batch.push_back(free_ids.back());
+      free_ids.pop_back();
+    }
+    if (batch.size() < id_batch_size) {
+      size_t last = fresh_id + (id_batch_size - batch.size());
+      // allocate the segments that will hold the new ids
+      for (int seg = segment_of(fresh_id) ; seg <= segment_of(last - 1) ; ++seg) {
+        if (segments[seg].load(std::memory_order_relaxed) == NULL) {
+          const T** segment = new const T* [segment_size(seg)];
+          std::fill(segment, segment + segment_size(seg), (const T*) NULL);
+          segments[seg].store(segment, std::memory_order_release);
+          std::atomic<id_t> * counts = new std::atomic<id_t> [segment_size(seg)];
+          for (size_t i = 0 ; i < segment_size(seg) ; ++i) {
+            counts[i].store(0, std::memory_order_relaxed);
+          }
+          ref_segments[seg].store(counts, std::memory_order_release);
+        }
+      }
+      // newest ids on top, so that they are used in increasing order
+      for (size_t id = last ; id > fresh_id ; --id) {
+        batch.push_back(id - 1);
+      }
+      fresh_id = last;
+      // so that marks and ages cover all ids
+      marks.resize(last, false);
+      ages.resize(last, 0);
+    }
+  }
+
+  /// return an id obtained by next_id and finally not used
+  void release_id (const id_t & id) {
+    local_ids().push_back(id);
+  }
+
+  /// return the next free id, from the batch of the calling thread
+  id_t next_id () {
+    std::vector<id_t> & batch = local_ids();
+    if (batch.empty()) {
+      fill_batch(batch);
+    }
+    id_t ret = batch.back();
+    batch.pop_back();
+    return ret;
+  }
+#else
   /// Typedef helps hide implementation type.
   /// The table wil hold actual entries for hashed unique test,
   /// These are the currently valid ids.
   typedef typename d3::hash_set<id_t, id_hash, id_compare>::type  table_t;
+#endif
   /// The Indexes table stores the id to (unique) T*  map.
   /// It also stores the free list in potential spare spaces.
   typedef typename std::vector<const T*>  indexes_t;
-  /// a sparse table holding refcounts for ref'd objects.
+  /// The reference counts, indexed by id. A dense array : ref and deref are a single access.
   /// Hopefully, we don't have more refs than there are nodes, id_t should be long enough to hold refcounts.
-  typedef typename google::sparsetable<id_t> refs_t;
+  typedef std::vector<id_t> refs_t;
+  /// High bit of a reference count, set while the id is in roots.
+  static const id_t rooted = id_t(1) << (8 * sizeof(id_t) - 1);
   /// A bitset to store marks on objects used for mark&sweep.
+#ifdef PARALLEL_DD
+  typedef d3::atomic_bitset marks_t;
+#else
   typedef std::vector<bool> marks_t;
+#endif
 
   /// The actual table, operations on the UniqueTable are delegated on this.
   table_t table; // Unique table of unique objects
+#ifndef REENTRANT
   /// The actual index table, resolution of object from Id is done with this
   indexes_t index; // Index table of unique objects
   /// The free list is stored hidden in the free space of the index table.
   /// It is sorted by reverse deallocation order, since we only
   /// push or pop to head. Value 0 signifies no successor(it is also the deleted key marker).
   id_t head;
-  /// The reference counters for ref'd nodes. It is a sparse table that only stores values for non-zero entries.
+#endif
+#ifndef REENTRANT
+  /// The reference counters, congruent with index. In REENTRANT builds see ref_slot().
   refs_t refs;
+  /// Number of calls to ref and deref, see ref_updates().
+  size_t ref_updates_;
+#else
+  std::atomic<size_t> ref_updates_;
+#endif
+  /// The ids that were ref'd since they entered the list, a superset of the ids with a positive
+  /// reference count. They are the heads of the mark phase, that also drops the unreferenced ones.
+  std::vector<id_t> roots;
   /// The marking entries, a bitset
   marks_t marks;
   // basic stats counter
   size_t peak_size_;
 
+  /// Number of collections survived by each id, up to promotion_age_ : ids of that age are old.
+  std::vector<unsigned char> ages;
+  /// The ids that are not old, the only ones swept by a minor collection.
+  std::vector<id_t> young;
+#ifdef REENTRANT
+  /// protects young during insertions
+  typedef tbb::spin_mutex young_mutex_t;
+  young_mutex_t young_mutex;
+#endif
+  /// Collections an id must survive to become old, 0 disables generations.
+  unsigned int promotion_age_;
+  /// A major collection occurs at least every major_period_ collections.
+  unsigned int major_period_;
+  /// Whether the next collection is major, decided at the end of the previous one
+  /// since mark() depends on it.
+  bool next_major_;
+  unsigned int minor_since_major_;
+  /// Size of the old generation after the last major collection.
+  size_t old_after_major_;
+  /// Number of threads used by garbage(), only PARALLEL_DD builds use more than one.
+  unsigned int gc_threads_;
+
+public:
+  /// What a collection did, see gc_history().
+  struct gc_stat {
+    /// whether the whole table was swept
+    bool major;
+    /// number of ids swept
+    size_t scanned;
+    /// number of objects destroyed
+    size_t reclaimed;
+    /// number of ids that became old
+    size_t promoted;
+    /// wall clock time spent in garbage_mark() and garbage_sweep(), in seconds
+    double pause;
+  };
+private:
+  std::vector<gc_stat> gc_history_;
+  /// The collection in progress, between garbage_mark() and garbage_sweep().
+  gc_stat current_;
+
+  /// Free the object of a dead id and recycle the id, the id is removed from table by the caller.
+#ifdef REENTRANT
+  /// The id is added to freed, that is later merged into free_ids.
+  void reclaim (const id_t & id, std::vector<id_t> & freed) {
+    // free memory allocated by clone
+    unique::destroy<T>() (resolve(id));
+    ages[id] = 0;
+    set_index(id, NULL);
+    freed.push_back(id);
+  }
+
+  void reclaim (const id_t & id) {
+    reclaim(id, free_ids);
+  }
+#else
+  void reclaim (const id_t & id) {
+    // free memory allocated by clone
+    unique::destroy<T>() (resolve(id));
+    ages[id] = 0;
+    // id may be recycled to designate something else.
+    push(id);
+  }
+#endif
+
+  /// A live id survived a collection, returns true if it is still young.
+  bool survive (const id_t & id, size_t & promoted) {
+    if (ages[id] >= promotion_age_) {
+      return false;
+    }
+    if (++ages[id] == promotion_age_) {
+      ++promoted;
+      return false;
+    }
+    return true;
+  }
+
+  /// mark phase, from refcounted entries
+  void mark_refs () {
+    // iterate over roots only, those no longer referenced leave the list
+    size_t kept = 0;
+    for (size_t i = 0 ; i < roots.size() ; ++i) {
+      id_t id = roots[i];
+#ifdef REENTRANT
+      std::atomic<id_t> & count = ref_slot(id);
+      if (count.load(std::memory_order_relaxed) == rooted) {
+	count.store(0, std::memory_order_relaxed);
+	continue;
+      }
+#else
+      id_t & count = refs[id];
+      if (count == rooted) {
+	count = 0;
+	continue;
+      }
+#endif
+      roots[kept++] = id;
+      mark(id);
+    }
+    roots.resize(kept);
+    //    std::cerr << "after mark ref'd : " ;  print_marked(std::cerr);
+  }
+
+  /// sweep phase, dead ids are erased from the table in place
+  void sweep (gc_stat & stat) {
+    if (stat.major) {
+      // sweep phase over the whole table, the young list is rebuilt
+      young.clear();
+      for(typename table_t::iterator di=table.begin() ; di!= table.end(); /* in loop */){
+	id_t id = *di;
+	// to avoid corruption when erasing
+	typename table_t::iterator ci = di;
+	++di;
+	++stat.scanned;
+	if (! marks[id] ) {
+	  table.erase(ci);
+	  reclaim(id);
+	  ++stat.reclaimed;
+	} else {
+	  marks[id] = false;
+	  if (survive(id, stat.promoted)) {
+	    young.push_back(id);
+	  }
+	}
+      }
+    } else {
+      // sweep phase over young ids only
+      size_t kept = 0;
+      for (size_t i = 0 ; i < young.size() ; ++i) {
+	id_t id = young[i];
+	++stat.scanned;
+	if (! marks[id] ) {
+	  // erase uses the hash of the object, before it is destroyed
+#ifdef REENTRANT
+	  table.erase(resolve(id)->hash(), id);
+#else
+	  table.erase(id);
+#endif
+	  reclaim(id);
+	  ++stat.reclaimed;
+	} else {
+	  marks[id] = false;
+	  if (survive(id, stat.promoted)) {
+	    young[kept++] = id;
+	  }
+	}
+      }
+      young.resize(kept);
+    }
+  }
+
+#ifdef PARALLEL_DD
+  /// During a parallel mark, the ids newly marked by the calling thread, whose sons are not marked yet.
+  /// It is NULL otherwise, mark() then recurses on sons.
+  static std::vector<id_t> * & mark_frontier () {
+    static thread_local std::vector<id_t> * frontier = NULL;
+    return frontier;
+  }
+
+  typedef tbb::blocked_range<size_t> range_t;
+  typedef tbb::enumerable_thread_specific<std::vector<id_t> > local_frontiers_t;
+  /// grain of the parallel loops, in ids
+  static const size_t mark_grain = 64;
+  static const size_t sweep_grain = 4096;
+
+  /// parallel_for body, marks the sons of a slice of the frontier
+  struct mark_body {
+    UniqueTableId & ut;
+    const std::vector<id_t> & frontier;
+    local_frontiers_t & next;
+
+    void operator() (const range_t & r) const {
+      mark_frontier() = & next.local();
+      for (size_t i = r.begin() ; i != r.end() ; ++i) {
+        ut.resolve(frontier[i])->mark();
+      }
+      mark_frontier() = NULL;
+    }
+  };
+
+  /// Marks from ref'd ids, one level of the graph at a time, each level in parallel.
+  void parallel_mark () {
+    std::vector<id_t> frontier;
+    mark_frontier() = & frontier;
+    mark_refs();
+    mark_frontier() = NULL;
+
+    local_frontiers_t next;
+    while (! frontier.empty()) {
+      mark_body body = { *this, frontier, next };
+      tbb::parallel_for(range_t(0, frontier.size(), mark_grain), body);
+      frontier.clear();
+      for (typename local_frontiers_t::iterator it = next.begin() ; it != next.end() ; ++it) {
+	frontier.insert(frontier.end(), it->begin(), it->end());
+	it->clear();
+      }
+    }
+  }
+
+  /// What a thread did during a parallel sweep.
+  struct sweep_result {
+    std::vector<id_t> freed;
+    std::vector<id_t> young;
+    size_t scanned;
+    size_t reclaimed;
+    size_t promoted;
+
+    sweep_result () : scanned(0), reclaimed(0), promoted(0) {}
+  };
+  typedef tbb::enumerable_thread_specific<sweep_result> sweep_results_t;
+
+  void sweep_id (const id_t & id, sweep_result & res) {
+    ++res.scanned;
+    if (! marks[id] ) {
+      // erase uses the hash of the object, before it is destroyed
+      table.erase(resolve(id)->hash(), id);
+      reclaim(id, res.freed);
+      ++res.reclaimed;
+    } else {
+      marks[id] = false;
+      if (survive(id, res.promoted)) {
+	res.young.push_back(id);
+      }
+    }
+  }
+
+  /// parallel_for body of major collections, sweeps a range of ids
+  struct major_sweep_body {
+    UniqueTableId & ut;
+    sweep_results_t & results;
+
+    void operator() (const range_t & r) const {
+      sweep_result & res = results.local();
+      for (size_t id = r.begin() ; id != r.end() ; ++id) {
+	// ids that are not in the table have no object
+	if (ut.resolve(id) != NULL) {
+	  ut.sweep_id(id, res);
+	}
+      }
+    }
+  };
+
+  /// parallel_for body of minor collections, sweeps a range of the young list
+  struct minor_sweep_body {
+    UniqueTableId & ut;
+    const std::vector<id_t> & young;
+    sweep_results_t & results;
+
+    void operator() (const range_t & r) const {
+      sweep_result & res = results.local();
+      for (size_t i = r.begin() ; i != r.end() ; ++i) {
+	ut.sweep_id(young[i], res);
+      }
+    }
+  };
+
+  /// The sweep is partitioned by id ranges for a major collection, by ranges of the young list
+  /// for a minor one. Dead ids are erased from the table concurrently, which the table allows
+  /// for distinct values while nothing is inserted, see concurrent_hash_set::erase.
+  void parallel_sweep (gc_stat & stat) {
+    sweep_results_t results;
+    if (stat.major) {
+      major_sweep_body body = { *this, results };
+      tbb::parallel_for(range_t(2, fresh_id, sweep_grain), body);
+    } else {
+      minor_sweep_body body = { *this, young, results };
+      tbb::parallel_for(range_t(0, young.size(), sweep_grain), body);
+    }
+    young.clear();
+    table.release_retired();
+    for (typename sweep_results_t::iterator it = results.begin() ; it != results.end() ; ++it) {
+      stat.scanned += it->scanned;
+      stat.reclaimed += it->reclaimed;
+      stat.promoted += it->promoted;
+      free_ids.insert(free_ids.end(), it->freed.begin(), it->freed.end());
+      young.insert(young.end(), it->young.begin(), it->young.end());
+    }
+  }
+
+  /// Run by the task arena of garbage_mark()
+  struct parallel_mark_job {
+    UniqueTableId & ut;
+
+    void operator() () const {
+      ut.parallel_mark();
+    }
+  };
+
+  /// Run by the task arena of garbage_sweep()
+  struct parallel_sweep_job {
+    UniqueTableId & ut;
+    gc_stat & stat;
+
+    void operator() () const {
+      ut.parallel_sweep(stat);
+    }
+  };
+#endif
+
+#ifndef REENTRANT
   /// add a node to free list
   void push (const id_t & id) {
     // std::cerr << "b4 push (" <<id << ")"; print_free_list(std::cerr);
@@ -124,7 +606,9 @@ class UniqueTableId {
     if (head == 0) {
       id_t ret = index.size();
       index.push_back(NULL);
+      refs.push_back(0);
       marks.push_back(false);
+      ages.push_back(0);
       return ret;
     } else {
       id_t ret = head;
@@ -147,6 +631,8 @@ class UniqueTableId {
     os << std::endl;
   }
 
+#endif
+
   void print_table(std::ostream & os) const {
     os << "table ";
     for(table_it di=begin() ; di!= end(); /* in loop */){
@@ -164,7 +650,7 @@ class UniqueTableId {
 
   void print_marked(std::ostream & os) const {
     os << "marked : ";
-    for(size_t i = 0 ; i < index.size() ; i++) {
+    for(size_t i = 0 ; i < marks.size() ; i++) {
       if (marks[i]) {
 	os << i << " ";
       }
@@ -177,47 +663,66 @@ public:
 
   // mark an entry to be kept
   void mark (const id_t & id) {
+    // old entries are only collected by major collections
+    if (! next_major_ && ages[id] >= promotion_age_) {
+      return;
+    }
+#ifdef PARALLEL_DD
+    if (! marks.set(id)) {
+      std::vector<id_t> * frontier = mark_frontier();
+      if (frontier != NULL) {
+	// parallel mark, sons are marked with the next level
+	frontier->push_back(id);
+      } else {
+	resolve(id)->mark();
+      }
+    }
+#else
     if (! marks[id]) {
       marks[id] = true;
       resolve(id)->mark();
     }
+#endif
   }
 
   // reference a unique object.
   // refs are used as heads for mark & sweep
   void ref (const id_t & id) {
-    // make sure sparse table is large enough
-    if (refs.size() <= id) {
-      // exponential may be a bit too much
-      refs.resize((3*id)/2);
-      assert( refs.size() > id);
+#ifdef REENTRANT
+    ref_updates_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic<id_t> & count = ref_slot(id);
+    if (! (count.fetch_add(1, std::memory_order_relaxed) & rooted)
+	&& ! (count.fetch_or(rooted, std::memory_order_relaxed) & rooted)) {
+      // first reference since the id left roots, only one thread sets the bit
+      roots_mutex_t::scoped_lock lock(roots_mutex);
+      roots.push_back(id);
     }
-
-    // test is true if ref count  != 0
-    if (refs.test(id)) {
-      // increment
-      refs.set(id,refs.get(id)+1);
-    } else {
-//      std::cerr << "ref " << id <<  std::endl;
-      // set to 1
-      refs.set(id,1);
+#else
+    ++ref_updates_;
+    id_t & count = refs[id];
+    if (! (count & rooted)) {
+      count |= rooted;
+      roots.push_back(id);
     }
+    ++count;
+#endif
   }
   
   // dereference an object.
   // when refcount is 0, the object is collectible unless it gets marked during mark&sweep.
   void deref (const id_t & id) {
+#ifdef REENTRANT
+    ref_updates_.fetch_add(1, std::memory_order_relaxed);
     // assume refcount was > 0 
-    assert(refs.test(id));
-    id_t refc = refs.get(id);
-    if (refc==1) {
-//      std::cerr << "deref " << id <<  std::endl;
-      // set to 0 = erase refcount
-      refs.erase(id);
-    } else {
-      // decrement
-      refs.set(id, refc-1);
-    }
+    id_t count = ref_slot(id).fetch_sub(1, std::memory_order_relaxed);
+    assert(count & ~rooted);
+    ((void) count);
+#else
+    ++ref_updates_;
+    // assume refcount was > 0 
+    assert(refs[id] & ~rooted);
+    --refs[id];
+#endif
   }
 
   typedef typename table_t::const_iterator table_it; 
@@ -233,8 +738,24 @@ public:
 
   /// Provide an initial size for both hash and index tables.
   /// Both will grow as needed if this size is exceeded.
+#ifdef REENTRANT
+  UniqueTableId(size_t s=4096):
+    fresh_id(2), table (s), ref_updates_(0), peak_size_(0),
+    promotion_age_(2), major_period_(8), next_major_(false), minor_since_major_(0), old_after_major_(0),
+    gc_threads_(1)
+  {
+    for (int seg = 0 ; seg < nb_segments ; ++seg) {
+      segments[seg].store(NULL, std::memory_order_relaxed);
+      ref_segments[seg].store(NULL, std::memory_order_relaxed);
+    }
+    // ids 0 and 1 are reserved, see id_traits
+    marks.reserve(s);
+  }
+#else
   UniqueTableId(size_t s=4096):
-    table (s), head(0),peak_size_(0)
+    table (s), head(0), ref_updates_(0), peak_size_(0),
+    promotion_age_(2), major_period_(8), next_major_(false), minor_since_major_(0), old_after_major_(0),
+    gc_threads_(1)
   {
     index.reserve(s);
     // position 0 is used for deleted key marker
@@ -242,16 +763,25 @@ public:
     table.set_deleted_key(0);
     // position 1 is reserved for hash comparisons of temporary objects.
     index.push_back(NULL);
-    refs.resize(s);
-    // so that marks and index always have congruent sizes.
+    // so that refs, marks and index always have congruent sizes.
+    refs.reserve(s);
+    refs.push_back(0);
+    refs.push_back(0);
     marks.reserve(s);
     marks.push_back(false);
     marks.push_back(false);
+    ages.push_back(0);
+    ages.push_back(0);
   }
+#endif
 
 
   const T * resolve (const id_t & id) const {
+#ifdef REENTRANT
+    return index_slot(id);
+#else
     return index[id];
+#endif
   }
 
 /* Canonical */
@@ -262,6 +792,16 @@ public:
   id_t
     operator()(const T &_g)
   {
+#ifdef REENTRANT
+    key_equal eq = { &_g };
+    key_clone make = { &_g };
+    std::pair<id_t, bool> res = table.find_or_insert (_g.hash(), eq, make, clone_destroy());
+    if (res.second) {
+      young_mutex_t::scoped_lock lock(young_mutex);
+      young.push_back(res.first);
+    }
+    return res.first;
+#else
     const int tmpid = 1;
     // temporary store of object at index 0
     index[tmpid]=&_g;
@@ -285,8 +825,10 @@ public:
       assert(ref.second);
       ((void)ref); 
 //      access->second = id;
+      young.push_back(id);
       return id;
     }
+#endif
   }
 
   /// Returns the current number of filled entries in the table.
@@ -303,53 +845,114 @@ public:
     return peak_size_;
   }
   
+  /// Set the generational collection policy, see garbage().
+  /// \param promotion_age number of collections an object must survive to become old, 0 disables generations.
+  /// \param major_period maximal number of collections between two major collections.
+  void set_gc_policy (unsigned int promotion_age, unsigned int major_period) {
+    promotion_age_ = promotion_age < 255 ? promotion_age : 255;
+    major_period_ = major_period;
+    // ages were computed with the previous policy, a major collection fixes the young list
+    next_major_ = true;
+  }
+
+  /// Set the number of threads used by garbage(). Only PARALLEL_DD builds use more than one.
+  void set_gc_threads (unsigned int nb_threads) {
+    gc_threads_ = nb_threads > 0 ? nb_threads : 1;
+  }
+
+  /// Number of reference count updates (calls to ref and deref) since the last clear_ref_updates().
+  size_t ref_updates () const {
+    return ref_updates_;
+  }
+
+  void clear_ref_updates () {
+    ref_updates_ = 0;
+  }
+
+  /// The collections since last call to clear_gc_history().
+  const std::vector<gc_stat> & gc_history () const {
+    return gc_history_;
+  }
+
+  void clear_gc_history () {
+    gc_history_.clear();
+  }
+
+  /// Generational mark and sweep.
+  /// Objects that survive promotion_age_ collections become old. A minor collection neither marks
+  /// nor sweeps old objects, so its cost depends on the young generation only. This is sound
+  /// because sons are created before their parent and are marked whenever it is marked, so that
+  /// an old object only refers to old objects.
+  /// A major collection sweeps the whole table, it occurs every major_period_ collections or
+  /// when the old generation has doubled since the last major collection.
+  /// Sweeping erases dead ids from the table in place.
+  /// The collection is split in two phases, so that tables of operations can drop the entries
+  /// that refer to dead objects in between, see is_marked().
   void garbage () {
+    garbage_mark();
+    garbage_sweep();
+  }
+
+  /// First phase of garbage() : mark from ref'd ids.
+  void garbage_mark () {
     peak_size();
-    // currently mark and sweep mode.
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    gc_stat stat = { next_major_, 0, 0, 0, 0 };
+    current_ = stat;
 
     //     print_table(std::cerr);
-    //     print_free_list(std::cerr);
     //     print_marked(std::cerr);
 
-    // mark phase
-    // iterate over refcounted entries only 
-    for (typename refs_t::nonempty_iterator it = refs.nonempty_begin() ; it != refs.nonempty_end() ; ++it ) {
-      id_t id = refs.get_pos(it);
-      mark(id);
+#ifdef PARALLEL_DD
+    if (gc_threads_ > 1) {
+      tbb::task_arena arena (gc_threads_);
+      parallel_mark_job job = { *this };
+      arena.execute(job);
+    } else
+#endif
+    {
+      mark_refs();
     }
-    //    std::cerr << "after mark ref'd : " ;  print_marked(std::cerr);
+    current_.pause = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+  }
 
-    table_t newtable (table.size()*2);
-    newtable.set_deleted_key(0);
-    // sweep phase
-    for(table_it di=begin() ; di!= end();/*++ done in loop*/ ){
-      id_t id = *di;
-      // to avoid corruption if deleted
-//      table_it ci = di;
-      ++di;
-      if (id==0) {
-	continue;
-      }
-      // if not marked
-      if (! marks[id] ) {
-	// kill it
-	// mark an entry for deletion, the id should not be used again, 
-//	table.erase(ci);
-	// free memory allocated by clone
-	delete (T*) index[id];
-	// id may be recycled to designate something else.
-	push(id);
-      } else {
-	newtable.insert(id);
-      }
-      marks[id] = false;
+  /// Between garbage_mark() and garbage_sweep(), whether id survives the collection.
+  /// Old ids are not marked by a minor collection, but they survive it.
+  bool is_marked (const id_t & id) const {
+    return marks[id] || (! current_.major && ages[id] >= promotion_age_);
+  }
+
+  /// Second phase of garbage() : free unmarked ids.
+  void garbage_sweep () {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    gc_stat & stat = current_;
+#ifdef PARALLEL_DD
+    if (gc_threads_ > 1) {
+      tbb::task_arena arena (gc_threads_);
+      parallel_sweep_job job = { *this, stat };
+      arena.execute(job);
+    } else
+#endif
+    {
+      sweep(stat);
     }
-    // cleanup
-    table = newtable;
 
-//          print_table(std::cerr);
-//          print_free_list(std::cerr);
+    // choose the kind of the next collection
+    size_t old_size = table.size() - young.size();
+    if (stat.major) {
+      minor_since_major_ = 0;
+      old_after_major_ = old_size;
+    } else {
+      ++minor_since_major_;
+    }
+    next_major_ = promotion_age_ == 0
+      || minor_since_major_ + 1 >= major_period_
+      || old_size > 2 * old_after_major_;
 
+    stat.pause += std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+    gc_history_.push_back(stat);
+
+//          print_table(std::cerr);
   }
 
 
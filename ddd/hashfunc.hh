@@ -62,6 +62,21 @@ namespace ddd
     return a;
   }
 
+  /// Thomas Wang's 64 bit to 32 bit hash function.
+  inline uint32_t int64_hash(uint64_t a) {
+    a = (~a) + (a << 18);
+    a = a ^ (a >> 31);
+    a = a * 21;
+    a = a ^ (a >> 11);
+    a = a + (a << 6);
+    a = a ^ (a >> 22);
+    return (uint32_t) a;
+  }
+
+  /// Hash of a node identifier, whatever its width.
+  inline uint32_t id_hash(uint32_t a) { return int32_hash(a); }
+  inline uint32_t id_hash(uint64_t a) { return int64_hash(a); }
+
 
   /// \brief Knuth's Multiplicative hash function.
   ///
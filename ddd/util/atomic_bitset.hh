@@ -0,0 +1,110 @@
+#ifndef _ATOMIC_BITSET_HH_
+#define _ATOMIC_BITSET_HH_
+
+#include <atomic>
+#include <cstddef>
+
+namespace d3 {
+
+/// A resizable bitset whose bits can be set and reset concurrently, used for marks of the
+/// parallel garbage collector. It mimics the subset of std::vector<bool> used for marks.
+/// Resizing is not thread safe.
+class atomic_bitset
+{
+  typedef unsigned long word_t;
+  static const size_t word_bits = 8 * sizeof(word_t);
+
+  std::atomic<word_t> * words_;
+  size_t size_;
+  /// number of allocated words
+  size_t capacity_;
+
+  static size_t nb_words (size_t n) {
+    return (n + word_bits - 1) / word_bits;
+  }
+
+  atomic_bitset (const atomic_bitset &);
+  atomic_bitset & operator= (const atomic_bitset &);
+
+public:
+
+  /// Proxy returned by operator[], so that marks[i] = b works as with std::vector<bool>.
+  class reference
+  {
+    atomic_bitset & set_;
+    size_t pos_;
+  public:
+    reference (atomic_bitset & s, size_t pos) : set_ (s), pos_ (pos) {}
+    operator bool () const { return set_.test (pos_); }
+    reference & operator= (bool b) {
+      if (b) set_.set (pos_); else set_.reset (pos_);
+      return *this;
+    }
+  };
+
+  atomic_bitset () : words_ (NULL), size_ (0), capacity_ (0) {}
+
+  ~atomic_bitset () {
+    delete [] words_;
+  }
+
+  size_t size () const {
+    return size_;
+  }
+
+  /// allocate room for n bits at least
+  void reserve (size_t n) {
+    size_t new_words = nb_words (n);
+    if (new_words > capacity_) {
+      std::atomic<word_t> * words = new std::atomic<word_t> [new_words];
+      for (size_t i = 0; i < new_words; ++i) {
+        words[i].store (i < capacity_ ? words_[i].load (std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+      }
+      delete [] words_;
+      words_ = words;
+      capacity_ = new_words;
+    }
+  }
+
+  /// new bits are set to value
+  void resize (size_t n, bool value = false) {
+    if (nb_words (n) > capacity_) {
+      reserve (n > 2 * size_ ? n : 2 * size_);
+    }
+    size_t old_size = size_;
+    size_ = n;
+    for (size_t i = old_size; i < n; ++i) {
+      if (value) set (i); else reset (i);
+    }
+  }
+
+  void push_back (bool value) {
+    resize (size_ + 1, value);
+  }
+
+  bool test (size_t pos) const {
+    return words_[pos / word_bits].load (std::memory_order_relaxed) & (word_t (1) << (pos % word_bits));
+  }
+
+  /// set the bit, returns its previous value
+  bool set (size_t pos) {
+    word_t mask = word_t (1) << (pos % word_bits);
+    return words_[pos / word_bits].fetch_or (mask, std::memory_order_relaxed) & mask;
+  }
+
+  void reset (size_t pos) {
+    words_[pos / word_bits].fetch_and (~ (word_t (1) << (pos % word_bits)), std::memory_order_relaxed);
+  }
+
+  bool operator[] (size_t pos) const {
+    return test (pos);
+  }
+
+  reference operator[] (size_t pos) {
+    return reference (*this, pos);
+  }
+};
+
+} // namespace d3
+
+#endif /* _ATOMIC_BITSET_HH_ */
@@ -0,0 +1,146 @@
+#ifndef _BINARY_STREAM_HH_
+#define _BINARY_STREAM_HH_
+
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace d3 { namespace util {
+
+/// Buffers the bytes written to a stream, and encodes integers as varints :
+/// 7 bits per byte, least significant first, the high bit set on all bytes but the last.
+/// Used by the binary formats of saveDDDBinary and saveSDDBinary.
+class binary_writer {
+  std::ostream & os_;
+  char buffer_[1 << 16];
+  size_t pos_;
+public:
+  explicit binary_writer (std::ostream & os) : os_(os), pos_(0) {}
+  ~binary_writer () { flush(); }
+
+  void flush () {
+    os_.write(buffer_, pos_);
+    pos_ = 0;
+  }
+  void byte (unsigned char c) {
+    if (pos_ == sizeof(buffer_))
+      flush();
+    buffer_[pos_++] = c;
+  }
+  void varint (uint64_t v) {
+    while (v >= 0x80) {
+      byte((unsigned char) (v | 0x80));
+      v >>= 7;
+    }
+    byte((unsigned char) v);
+  }
+  /// signed integers are zigzag encoded, so that small negative values stay short
+  void svarint (int64_t v) {
+    varint(((uint64_t) v << 1) ^ (uint64_t) (v >> 63));
+  }
+};
+
+/// Decodes the varints of binary_writer from the buffer of a stream. Exactly the bytes of the
+/// encoded data are consumed, so that other data may follow them in the stream.
+/// Reports truncated or corrupt input by throwing std::runtime_error, prefixed by the name
+/// of the loading function.
+class binary_reader {
+  std::istream & is_;
+  std::streambuf * buf_;
+  const char * name_;
+public:
+  binary_reader (std::istream & is, const char * name) : is_(is), buf_(is.rdbuf()), name_(name) {}
+
+  /// throws std::runtime_error with the message "name : what"
+  void error (const char * what) const {
+    throw std::runtime_error(std::string(name_) + " : " + what);
+  }
+
+  unsigned char byte () {
+    int c = buf_->sbumpc();
+    if (c == std::char_traits<char>::eof()) {
+      is_.setstate(std::ios::eofbit | std::ios::failbit);
+      error("unexpected end of stream");
+    }
+    return (unsigned char) c;
+  }
+  uint64_t varint () {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      unsigned char c = byte();
+      v |= (uint64_t) (c & 0x7f) << shift;
+      if (! (c & 0x80))
+        return v;
+    }
+    error("malformed integer");
+    return 0;
+  }
+  int64_t svarint () {
+    uint64_t v = varint();
+    return (int64_t) (v >> 1) ^ - (int64_t) (v & 1);
+  }
+};
+
+/// Writes the runs of the DDD node d : their number, then each run as its gap to the previous
+/// run, its width, and how far back its son is numbered, given by back(son).
+template <typename Node, typename Back>
+void write_runs (binary_writer & out, const Node & d, Back back)
+{
+  out.varint(d.nbruns());
+  typename Node::wide_val_t next = 0;
+  bool first = true;
+  typename Node::const_run_iterator end = d.runs_end();
+  for (typename Node::const_run_iterator vi = d.runs_begin(); vi != end; ++vi) {
+    if (first)
+      out.svarint(vi->lo);
+    else
+      out.varint(vi->lo - next);
+    first = false;
+    out.varint(vi->hi - vi->lo);
+    out.varint(back(vi->son));
+    next = typename Node::wide_val_t (vi->hi) + 1;
+  }
+}
+
+/// Reads the runs written by write_runs into the builder of a node, whose sons are numbered
+/// in nodes, from null at index 0.
+template <typename Builder, typename Node>
+void read_runs (binary_reader & in, Builder & value, const std::vector<Node> & nodes)
+{
+  typedef typename Node::val_t val_t;
+  const int64_t min_val = std::numeric_limits<val_t>::min();
+  const int64_t max_val = std::numeric_limits<val_t>::max();
+  const size_t i = nodes.size();
+  uint64_t nbruns = in.varint();
+  // values lower than lo are taken by the previous runs
+  int64_t lo = min_val;
+  for (uint64_t r = 0; r < nbruns; ++r) {
+    int64_t start;
+    if (r == 0) {
+      start = in.svarint();
+    } else {
+      uint64_t gap = in.varint();
+      start = (lo > max_val || gap > (uint64_t) (max_val - lo)) ? max_val + 1 : lo + (int64_t) gap;
+    }
+    uint64_t width = in.varint();
+    uint64_t back = in.varint();
+    if (start < lo || start > max_val || width > (uint64_t) (max_val - start))
+      in.error("value out of range");
+    // the son is numbered before the node, and is not null
+    if (back == 0 || back >= i)
+      in.error("bad son index");
+    value.add((val_t) start, (val_t) (start + width), nodes[i - back]);
+    lo = start + (int64_t) width + 1;
+  }
+  if (value.empty())
+    in.error("node without arcs");
+}
+
+}} // namespace d3::util
+
+#endif /* _BINARY_STREAM_HH_ */
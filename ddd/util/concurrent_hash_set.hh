@@ -0,0 +1,280 @@
+#ifndef _CONCURRENT_HASH_SET_HH_
+#define _CONCURRENT_HASH_SET_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "tbb/spin_rw_mutex.h"
+
+namespace d3 {
+
+/// An insert-only open addressing hash set, for use as unicity table in REENTRANT builds.
+///
+/// Values are small scalars (pointers or ids) stored in an array of atomic slots, probed linearly.
+/// Two values are reserved : Traits::empty() marks a free slot and Traits::erased() a slot freed
+/// by erase. Hash and equality are given by the contents the values designate, so they are
+/// provided by the caller (see find_or_insert).
+///
+/// Concurrency :
+///  * lookups do not lock, they only read slots;
+///  * an insertion that missed takes the shared side of a reader/writer spin lock, and
+///    publishes the new value with a compare and swap on the free slot, so inserting threads
+///    do not serialize. If two threads race for the same key, one of them wins the slot and
+///    the other one drops its copy;
+///  * growing the array takes the exclusive side of the lock. The old array is left untouched
+///    (lookups running in it stay valid) and is freed later, when iterating the set.
+///  * iteration requires that no other thread uses the set, it is meant for the sweep phase
+///    of garbage collection;
+///  * erase(h,v) may run concurrently with other calls of erase(h,v) for distinct values, but
+///    not with insertion or iteration : the parallel sweep erases the dead ids from all threads.
+template <typename Value, typename Traits, typename Hash>
+class concurrent_hash_set
+{
+  typedef std::atomic<Value> slot_t;
+
+  struct bucket_array
+  {
+    /// a power of two
+    size_t capacity;
+    slot_t * slots;
+
+    bucket_array (size_t c) : capacity (c), slots (new slot_t [c]) {
+      for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store (Traits::empty (), std::memory_order_relaxed);
+      }
+    }
+    ~bucket_array () {
+      delete [] slots;
+    }
+  };
+
+  typedef tbb::spin_rw_mutex resize_mutex_t;
+
+  /// the array currently used for insertion
+  std::atomic<bucket_array *> current_;
+  /// number of values in the set
+  std::atomic<size_t> size_;
+  /// number of slots of the current array that are not free (values and erased slots)
+  std::atomic<size_t> used_;
+  /// shared for insertion, exclusive for resize
+  resize_mutex_t resize_mutex_;
+  /// arrays replaced by a resize, that lookups may still be reading
+  std::vector<bucket_array *> retired_;
+  Hash hash_;
+
+  static size_t round_up (size_t s) {
+    size_t c = 16;
+    while (c < s) {
+      c *= 2;
+    }
+    return c;
+  }
+
+  bool is_value (Value v) const {
+    return v != Traits::empty () && v != Traits::erased ();
+  }
+
+  /// the array is full when half of its slots are used
+  bool too_full (const bucket_array * a) const {
+    return 2 * (used_.load (std::memory_order_relaxed) + 1) > a->capacity;
+  }
+
+  /// probe a for a value matching eq, stop on the first free slot
+  template <typename Equal>
+  Value lookup (const bucket_array * a, size_t h, const Equal & eq) const {
+    size_t mask = a->capacity - 1;
+    for (size_t i = h & mask, n = 0; n < a->capacity; i = (i + 1) & mask, ++n) {
+      Value v = a->slots[i].load (std::memory_order_acquire);
+      if (v == Traits::empty ()) {
+        break;
+      }
+      if (v != Traits::erased () && eq (v)) {
+        return v;
+      }
+    }
+    return Traits::empty ();
+  }
+
+  /// place a value known to be absent, used by resize only (exclusive access)
+  void place (bucket_array * a, Value v) {
+    size_t mask = a->capacity - 1;
+    size_t i = hash_ (v) & mask;
+    while (a->slots[i].load (std::memory_order_relaxed) != Traits::empty ()) {
+      i = (i + 1) & mask;
+    }
+    a->slots[i].store (v, std::memory_order_relaxed);
+  }
+
+  /// rehash live values into an array with room for twice as many, called with exclusive lock
+  void resize () {
+    bucket_array * old = current_.load (std::memory_order_relaxed);
+    size_t live = size_.load (std::memory_order_relaxed);
+    bucket_array * a = new bucket_array (round_up (4 * (live + 1)));
+    for (size_t i = 0; i < old->capacity; ++i) {
+      Value v = old->slots[i].load (std::memory_order_relaxed);
+      if (is_value (v)) {
+        place (a, v);
+      }
+    }
+    used_.store (live, std::memory_order_relaxed);
+    retired_.push_back (old);
+    current_.store (a, std::memory_order_release);
+  }
+
+  concurrent_hash_set (const concurrent_hash_set &);
+  concurrent_hash_set & operator= (const concurrent_hash_set &);
+
+public:
+
+  concurrent_hash_set (size_t s = 16, const Hash & h = Hash ())
+    : current_ (new bucket_array (round_up (2 * s)))
+    , size_ (0)
+    , used_ (0)
+    , hash_ (h)
+  {}
+
+  ~concurrent_hash_set () {
+    release_retired ();
+    delete current_.load ();
+  }
+
+  /// Return the value matching eq if there is one, otherwise insert make() and return it.
+  /// The boolean is true if the value was inserted by this call.
+  /// \param h the hash of the key, it should be equal to Hash()(v) for the matching value v.
+  /// \param eq predicate on stored values, true for the value matching the key.
+  /// \param make builds the value to insert, called at most once.
+  /// \param drop called on the value built by make if another thread inserted an equal value first.
+  template <typename Equal, typename Make, typename Drop>
+  std::pair<Value, bool> find_or_insert (size_t h, const Equal & eq, const Make & make, const Drop & drop) {
+    // lock free lookup, most calls are hits
+    Value found = lookup (current_.load (std::memory_order_acquire), h, eq);
+    if (found != Traits::empty ()) {
+      return std::make_pair (found, false);
+    }
+
+    Value created = Traits::empty ();
+    while (true) {
+      resize_mutex_t::scoped_lock lock (resize_mutex_, /* write */ false);
+      bucket_array * a = current_.load (std::memory_order_acquire);
+      if (too_full (a)) {
+        // only one thread resizes, others find the new array when they get the lock back
+        if (lock.upgrade_to_writer () || current_.load (std::memory_order_relaxed) == a) {
+          if (too_full (a)) {
+            resize ();
+          }
+        }
+        continue;
+      }
+      size_t mask = a->capacity - 1;
+      for (size_t i = h & mask; ; i = (i + 1) & mask) {
+        Value v = a->slots[i].load (std::memory_order_acquire);
+        if (v == Traits::empty ()) {
+          if (created == Traits::empty ()) {
+            created = make ();
+          }
+          if (a->slots[i].compare_exchange_strong (v, created, std::memory_order_acq_rel)) {
+            size_.fetch_add (1, std::memory_order_relaxed);
+            used_.fetch_add (1, std::memory_order_relaxed);
+            return std::make_pair (created, true);
+          }
+          // lost the slot, v is now the value of the winner : test it below
+        }
+        if (v != Traits::erased () && eq (v)) {
+          if (created != Traits::empty ()) {
+            drop (created);
+          }
+          return std::make_pair (v, false);
+        }
+      }
+    }
+  }
+
+  /// Free the arrays replaced by resize. Not thread safe, see iteration.
+  void release_retired () {
+    for (typename std::vector<bucket_array *>::iterator it = retired_.begin() ; it != retired_.end() ; ++it) {
+      delete *it;
+    }
+    retired_.clear ();
+  }
+
+  /// Number of values in the set.
+  size_t size () const {
+    return size_.load (std::memory_order_relaxed);
+  }
+
+  /// Number of slots of the current array.
+  size_t capacity () const {
+    return current_.load (std::memory_order_relaxed)->capacity;
+  }
+
+  /// Iteration over values. Not thread safe : no other thread should use the set meanwhile.
+  class const_iterator
+  {
+    friend class concurrent_hash_set;
+    const bucket_array * a_;
+    size_t i_;
+
+    void skip () {
+      while (i_ < a_->capacity) {
+        Value v = a_->slots[i_].load (std::memory_order_relaxed);
+        if (v != Traits::empty () && v != Traits::erased ())
+          break;
+        ++i_;
+      }
+    }
+    const_iterator (const bucket_array * a, size_t i) : a_ (a), i_ (i) { skip (); }
+  public:
+    const_iterator () : a_ (NULL), i_ (0) {}
+    Value operator* () const { return a_->slots[i_].load (std::memory_order_relaxed); }
+    const_iterator & operator++ () { ++i_; skip (); return *this; }
+    const_iterator operator++ (int) { const_iterator tmp = *this; ++*this; return tmp; }
+    bool operator== (const const_iterator & o) const { return i_ == o.i_; }
+    bool operator!= (const const_iterator & o) const { return i_ != o.i_; }
+  };
+  typedef const_iterator iterator;
+
+  /// Iterating requires exclusive access, so it is also where retired arrays are freed.
+  const_iterator begin () {
+    release_retired ();
+    return const_iterator (current_.load (std::memory_order_relaxed), 0);
+  }
+  const_iterator begin () const {
+    return const_iterator (current_.load (std::memory_order_relaxed), 0);
+  }
+  const_iterator end () const {
+    const bucket_array * a = current_.load (std::memory_order_relaxed);
+    return const_iterator (a, a->capacity);
+  }
+
+  /// Remove the value v, of hash h, if it is in the set.
+  /// Threads may erase distinct values concurrently, as long as no thread inserts or iterates
+  /// meanwhile : no array is then replaced, the only slot written is the one holding v, and
+  /// probes of other values skip erased slots whatever the order of the writes.
+  void erase (size_t h, Value v) {
+    bucket_array * a = current_.load (std::memory_order_relaxed);
+    size_t mask = a->capacity - 1;
+    for (size_t i = h & mask, n = 0; n < a->capacity; i = (i + 1) & mask, ++n) {
+      Value cur = a->slots[i].load (std::memory_order_relaxed);
+      if (cur == Traits::empty ()) {
+        return;
+      }
+      if (cur == v) {
+        a->slots[i].store (Traits::erased (), std::memory_order_relaxed);
+        size_.fetch_sub (1, std::memory_order_relaxed);
+        return;
+      }
+    }
+  }
+
+  /// Remove the value at it. Not thread safe, see iteration.
+  void erase (const_iterator it) {
+    current_.load (std::memory_order_relaxed)->slots[it.i_].store (Traits::erased (), std::memory_order_relaxed);
+    size_.fetch_sub (1, std::memory_order_relaxed);
+  }
+};
+
+} // namespace d3
+
+#endif /* _CONCURRENT_HASH_SET_HH_ */
@@ -121,7 +121,7 @@ public :
 	    tmp3 << "[";
 	    for (DDD::const_iterator it = arc.begin() ; it != arc.end() ; /** increment in loop */ ) {
 	      if (it->second == DDD::one) {
-		tmp3 << it->first ;
+		tmp3 << int(it->first) ;
 		++it;
 		if (it != arc.end()) tmp3 << ",";
 	      } else {
@@ -235,7 +235,7 @@ public :
 	int max = gi->first;
 	if (min == max) {
       	  // use  next line for only one terminal node
-	  (*D3out) << "     " << tmp.str() << "->" << d3name[gi->second] << "    [label=\""<< gi->first << "\"];" <<endl;
+	  (*D3out) << "     " << tmp.str() << "->" << d3name[gi->second] << "    [label=\""<< int(gi->first) << "\"];" <<endl;
 	} else  {
 	  (*D3out) << "     " << tmp.str() << "->" << d3name[gi->second] << "    [label=\""<< min << ".." << max << "\"];" <<endl;
 	}
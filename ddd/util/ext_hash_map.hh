@@ -155,6 +155,10 @@ private:
   friend class const_accessor;
   friend class accessor;
   internal_hash_map map_;
+#ifndef USE_STD_HASH
+  /// whether Key() was set as deleted key marker, see erase_if
+  bool deleted_key_set_;
+#endif
 
   // Methods
 public:
@@ -162,12 +166,18 @@ public:
   ext_hash_map()
     :
     map_()
+#ifndef USE_STD_HASH
+    , deleted_key_set_(false)
+#endif
   {
   }
 
   ext_hash_map(size_t s)
     :
     map_(s)
+#ifndef USE_STD_HASH
+    , deleted_key_set_(false)
+#endif
   {
   }
 
@@ -246,6 +256,39 @@ public:
   {
     return map_.erase(key) > 1 ? false : true; 
   }
+
+  /// Remove the entries for which pred holds, pred is called once on each entry.
+  /// Entries are erased in place. With google's sparse_hash_map this requires a deleted key
+  /// marker : Key() is used, so it must never be a key of the table.
+  template <typename Pred>
+  size_type
+  erase_if( Pred pred)
+  {
+    size_type removed = 0;
+#ifndef USE_STD_HASH
+    if (! deleted_key_set_) {
+      map_.set_deleted_key(Key());
+      deleted_key_set_ = true;
+    }
+    for (iterator it = map_.begin(); it != map_.end(); ++it) {
+      if (pred(*it)) {
+        // sparse_hash_map::erase does not invalidate iterators
+        map_.erase(it);
+        ++removed;
+      }
+    }
+#else
+    for (iterator it = map_.begin(); it != map_.end(); ) {
+      if (pred(*it)) {
+        it = map_.erase(it);
+        ++removed;
+      } else {
+        ++it;
+      }
+    }
+#endif
+    return removed;
+  }
   
 #ifdef HASH_STAT
   std::map<std::string, size_t> get_hits() const { return map_.get_hits(); }
@@ -226,6 +226,18 @@ struct clone<std::vector<int> >
        return new std::vector<int>(e1);
      }
 };
+
+// the matching release of memory obtained through clone.
+// Specialize it together with clone if T is not allocated with a plain new.
+template<typename T>
+struct destroy
+{
+  void
+  operator()(const T* e1) const
+  {
+    delete e1;
+  }
+};
  
 }
 
@@ -4,7 +4,8 @@
 #ifdef REENTRANT
 
 #include <tbb/concurrent_hash_map.h>
-#include <tbb/mutex.h>
+#include <mutex>
+#include <vector>
 
 #include "ddd/util/hash_support.hh"
 
@@ -20,13 +21,13 @@ struct tbb_hash_map
   struct hash_compare
   {    
     bool
-    equal( const Key& k1, const Key& k2)
+    equal( const Key& k1, const Key& k2) const
     {
       return EqualKey()(k1,k2);
     }
 
     size_t
-    hash( const Key& k)
+    hash( const Key& k) const
     {
       return HashKey()(k);
     }
@@ -34,7 +35,7 @@ struct tbb_hash_map
   };
 
   // Types
-  typedef tbb::mutex mutex;
+  typedef std::mutex mutex;
   typedef tbb::concurrent_hash_map<Key,Data,hash_compare> internal_hash_map;
   typedef typename internal_hash_map::iterator iterator;
   typedef typename internal_hash_map::const_iterator const_iterator;
@@ -54,6 +55,21 @@ struct tbb_hash_map
   {
   }
 
+  /// copies the entries, the copy has its own mutex
+  tbb_hash_map( const tbb_hash_map& other)
+    :
+    map_(other.map_),
+    map_mutex_()
+  {
+  }
+
+  tbb_hash_map&
+  operator=( const tbb_hash_map& other)
+  {
+    map_ = other.map_;
+    return *this;
+  }
+
   iterator
   begin()
   {
@@ -94,7 +110,7 @@ struct tbb_hash_map
   clear()
   {
     // non reentrant method, need to lock the hash_map
-    mutex::scoped_lock lock(map_mutex_);
+    std::lock_guard<mutex> lock(map_mutex_);
     map_.clear();
   }
 
@@ -128,6 +144,33 @@ struct tbb_hash_map
     return map_.erase(key);
   }
 
+  /// Remove the entries for which pred holds, pred is called once on each entry.
+  /// The kept entries are inserted back after clearing the map, so pred may release the
+  /// resources of the keys it removes.
+  /// Not reentrant : no other thread should use the map meanwhile.
+  template <typename Pred>
+  size_type
+  erase_if( Pred pred)
+  {
+    std::vector<std::pair<Key, Data> > kept;
+    size_type size = map_.size();
+    for (const_iterator it = map_.begin(); it != map_.end(); ++it) {
+      if (! pred(*it)) {
+        kept.push_back(*it);
+      }
+    }
+    if (kept.size() == size) {
+      return 0;
+    }
+    map_.clear();
+    for (typename std::vector<std::pair<Key, Data> >::const_iterator it = kept.begin(); it != kept.end(); ++it) {
+      accessor access;
+      map_.insert(access, it->first);
+      access->second = it->second;
+    }
+    return size - kept.size();
+  }
+
 };
 
 #endif // REENTRANT
@@ -0,0 +1,130 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Micro benchmark of the layout of the arcs of wide DDD nodes.
+ *  Builds pairs of distinct wide nodes whose runs lead to pseudo random leaves, then times
+ *  lookups by value (GDDD::find), intersections and differences of wide nodes, and the same
+ *  operations between a wide node and a node of a few arcs.
+ *  Build the library with and without --enable-soa-arcs to compare the two layouts.
+ *  usage : arcs_bench [width [nbnodes]] */
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+
+static int WIDTH = 1024;
+static int NB_NODES = 2000;
+// number of distinct leaves used as sons
+static const int NB_LEAVES = 64;
+// number of lookups by value per node
+static const int NB_FINDS = 1000;
+
+// the node number k : a value out of 4 has no arc, the others point to a pseudo random leaf,
+// so that nodes (almost always) differ and have about 3*WIDTH/4 runs
+static GDDD build (int k, const vector<DDD> & leaves) {
+  GDDD::Builder b(0);
+  for (int i = 0; i < WIDTH; ++i) {
+    size_t h = ddd::int32_hash(k * WIDTH + i);
+    if (h % 4 != 0)
+      b.add(i, leaves[h % NB_LEAVES]);
+  }
+  return b.finalize();
+}
+
+static void report (const char * phase, double time, size_t ops) {
+  cout << phase << "," << ops << "," << time << "," << (time > 0 ? ops / time : 0) << endl;
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    WIDTH = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    NB_NODES = atoi(argv[2]);
+  }
+
+  vector<DDD> leaves;
+  for (int i = 0; i < NB_LEAVES; ++i) {
+    leaves.push_back(DDD(1, i));
+  }
+  vector<DDD> nodes;
+  nodes.reserve(NB_NODES);
+  for (int k = 0; k < NB_NODES; ++k) {
+    nodes.push_back(build(k, leaves));
+  }
+  // nodes of a few arcs, spread over the values
+  vector<DDD> small;
+  small.reserve(NB_NODES);
+  for (int k = 0; k < NB_NODES; ++k) {
+    small.push_back(DDD(0, (k * 7) % WIDTH, leaves[k % NB_LEAVES]) + DDD(0, (k * 13) % WIDTH, leaves[(k + 1) % NB_LEAVES]));
+  }
+
+#ifdef DDD_SOA_ARCS
+  cout << "Layout : arrays of bounds and sons" << endl;
+#else
+  cout << "Layout : array of runs" << endl;
+#endif
+  cout << "Phase ,ops ,Time(s) ,ops/s" << endl;
+
+  double start = process::getTotalTime();
+  size_t found = 0;
+  for (int k = 0; k < NB_NODES; ++k) {
+    for (int i = 0; i < NB_FINDS; ++i) {
+      if (nodes[k].find((i * 37) % WIDTH) != nodes[k].runs_end())
+        ++found;
+    }
+  }
+  report("find", process::getTotalTime() - start, (size_t) NB_NODES * NB_FINDS);
+
+  // every operation is on distinct operands, so none is answered by the cache
+  start = process::getTotalTime();
+  for (int k = 0; k + 1 < NB_NODES; k += 2) {
+    DDD res = nodes[k] * nodes[k + 1];
+  }
+  report("wide*wide", process::getTotalTime() - start, NB_NODES / 2);
+
+  start = process::getTotalTime();
+  for (int k = 0; k + 1 < NB_NODES; k += 2) {
+    DDD res = nodes[k] - nodes[k + 1];
+  }
+  report("wide-wide", process::getTotalTime() - start, NB_NODES / 2);
+
+  start = process::getTotalTime();
+  for (int k = 0; k < NB_NODES; ++k) {
+    DDD res = small[k] * nodes[k];
+  }
+  report("small*wide", process::getTotalTime() - start, NB_NODES);
+
+  start = process::getTotalTime();
+  for (int k = 0; k < NB_NODES; ++k) {
+    DDD res = small[k] - nodes[k];
+  }
+  report("small-wide", process::getTotalTime() - start, NB_NODES);
+
+  cout << "Mem(kb) : " << process::getResidentMemory() << endl;
+
+  return found != 0 ? 0 : 1;
+}
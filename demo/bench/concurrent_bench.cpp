@@ -0,0 +1,103 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Scaling benchmark of the DDD unique table in a REENTRANT build.
+ *  For 1, 2, 4, 8 and 16 threads, the same total number of nodes is created, split
+ *  between threads. Half of the nodes of a thread are private, the other half are
+ *  also built by every other thread, so that threads race to insert them.
+ *  usage : concurrent_bench [width [nbnodes]] */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/MemoryManager.h"
+
+static int WIDTH = 16;
+static int NB_NODES = 400000;
+// number of distinct leaves used as sons
+static const int NB_LEAVES = 64;
+
+static vector<DDD> leaves;
+
+// the node number k : arc i points to a pseudo random leaf, so that nodes (almost always) differ
+static GDDD build (int k) {
+  GDDD::Valuation val;
+  val.reserve(WIDTH);
+  for (int i = 0; i < WIDTH; ++i) {
+    val.push_back(GDDD::edge_t(i, leaves[ddd::int32_hash(k * WIDTH + i) % NB_LEAVES]));
+  }
+  return GDDD(0, val);
+}
+
+// thread t of nbthreads builds its private nodes and all the shared ones
+static void work (int t, int nbthreads, vector<GDDD> & shared) {
+  int per_thread = NB_NODES / nbthreads;
+  for (int k = 0; k < per_thread / 2; ++k) {
+    build(NB_NODES + t * per_thread + k);
+    shared[k] = build(k);
+  }
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    WIDTH = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    NB_NODES = atoi(argv[2]);
+  }
+
+  for (int i = 0; i < NB_LEAVES; ++i) {
+    leaves.push_back(DDD(1, i));
+  }
+
+  cout << "Threads ,nodes ,Time(s) ,nodes/s ,unique nodes" << endl;
+  int errors = 0;
+  for (int nbthreads = 1; nbthreads <= 16; nbthreads *= 2) {
+    vector<vector<GDDD> > shared (nbthreads, vector<GDDD> (NB_NODES / nbthreads / 2));
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int t = 0; t < nbthreads; ++t) {
+      threads.push_back(thread(work, t, nbthreads, ref(shared[t])));
+    }
+    for (int t = 0; t < nbthreads; ++t) {
+      threads[t].join();
+    }
+    double time = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+    size_t nodes = (size_t) nbthreads * (NB_NODES / nbthreads);
+    cout << nbthreads << "," << nodes << "," << time << "," << (time > 0 ? nodes / time : 0)
+         << "," << MemoryManager::nbDDD() << endl;
+
+    // every thread should have obtained the same shared nodes
+    for (int t = 1; t < nbthreads; ++t) {
+      if (shared[t] != shared[0]) {
+        ++errors;
+      }
+    }
+    shared.clear();
+    MemoryManager::garbage();
+  }
+  return errors;
+}
@@ -0,0 +1,159 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Benchmark of the strategies of fixpoint evaluation.
+ *  Computes the reachable states of the towers of Hanoi as the fixpoint of the union of
+ *  the moves and the identity, as hanoi_v2 does, over a DDD and over a SDD whose single
+ *  variable holds the DDD. Compared strategies :
+ *   - whole set : the union is applied to all the reached states at each iteration,
+ *   - FRONTIER : it is only applied to the states reached by the previous iteration,
+ *   - BFS and DFS : saturation, the default.
+ *  Then compares the saturation strategies of DDD homomorphisms, ORDINARY, CHAINING and
+ *  RECFIREANDSAT, on the events of hanoi_v1_ter : one event per ring and pair of poles, so
+ *  that several events are fired at the level of each ring.
+ *  For each, prints the time and the number of nodes left in the unicity table by the
+ *  computation, an estimate of the intermediate nodes built.
+ *  usage : fixpoint_bench [nbrings] */
+#include <cstdlib>
+#include <iostream>
+#include <set>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/Hom.h"
+#include "ddd/SDD.h"
+#include "ddd/SHom.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+#include "../hanoi/hanoiHom.hh"
+
+static Hom events () {
+  set<GHom> moves;
+  for (int i = 0; i < NB_RINGS; ++i) {
+    moves.insert(move_ring(i));
+  }
+  return GHom::add(moves) + GHom::id;
+}
+
+// the events of hanoi_v1_ter
+static Hom swap_events () {
+  set<GHom> moves;
+  for (int i = 0; i < NB_RINGS; ++i) {
+    for (int ori = 0; ori < NB_POLES; ++ori) {
+      for (int dest = 0; dest < NB_POLES; ++dest) {
+        if (ori != dest) {
+          moves.insert(swap_pole(i, ori, dest));
+        }
+      }
+    }
+  }
+  return GHom::add(moves) + GHom::id;
+}
+
+static Shom sevents () {
+  set<GShom> moves;
+  for (int i = 0; i < NB_RINGS; ++i) {
+    moves.insert(localApply(move_ring(i), 0));
+  }
+  return GShom::add(moves) + GShom::id;
+}
+
+static void report (const char * name, double start, long double states) {
+  cout << name << "," << states << "," << process::getTotalTime() - start
+       << "," << MemoryManager::nbDDD() << "," << MemoryManager::nbSDD() << endl;
+  MemoryManager::garbage();
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    NB_RINGS = atoi(argv[1]);
+  }
+  initName();
+
+  // the initial state, all rings are on pole 0
+  DDD M0 = GDDD::one;
+  for (int i = 0; i < NB_RINGS; ++i) {
+    M0 = DDD(i, 0, M0);
+  }
+  SDD M1 = SDD(0, M0);
+  MemoryManager::garbage();
+
+  cout << "Strategy ,|S| ,Time(s) ,DDD nodes ,SDD nodes" << endl;
+
+  double start = process::getTotalTime();
+  {
+    Hom h = events();
+    DDD reached = M0;
+    while (true) {
+      DDD next = h(reached);
+      if (next == reached)
+        break;
+      reached = next;
+    }
+    report("DDD whole set", start, reached.nbStates());
+  }
+
+  const GHom::fixpointStrategy strats [] = { GHom::FRONTIER, GHom::BFS, GHom::DFS };
+  const char * names [] = { "DDD FRONTIER", "DDD BFS", "DDD DFS" };
+  for (int s = 0; s < 3; ++s) {
+    GHom::setFixpointStrategy(strats[s]);
+    start = process::getTotalTime();
+    DDD reached = fixpoint(events())(M0);
+    report(names[s], start, reached.nbStates());
+  }
+  GHom::setFixpointStrategy(GHom::BFS);
+
+  start = process::getTotalTime();
+  {
+    Shom h = sevents();
+    SDD reached = M1;
+    while (true) {
+      SDD next = h(reached);
+      if (next == reached)
+        break;
+      reached = next;
+    }
+    report("SDD whole set", start, reached.nbStates());
+  }
+
+  const GShom::fixpointStrategy sstrats [] = { GShom::FRONTIER, GShom::BFS, GShom::DFS };
+  const char * snames [] = { "SDD FRONTIER", "SDD BFS", "SDD DFS" };
+  for (int s = 0; s < 3; ++s) {
+    GShom::setFixpointStrategy(sstrats[s]);
+    start = process::getTotalTime();
+    SDD reached = fixpoint(sevents())(M1);
+    report(snames[s], start, reached.nbStates());
+  }
+  GShom::setFixpointStrategy(GShom::BFS);
+
+  const GHom::saturationStrategy sats [] = { GHom::ORDINARY, GHom::CHAINING, GHom::RECFIREANDSAT };
+  const char * satnames [] = { "DDD swap ORDINARY", "DDD swap CHAINING", "DDD swap RECFIREANDSAT" };
+  for (int s = 0; s < 3; ++s) {
+    GHom::setSaturationStrategy(sats[s]);
+    start = process::getTotalTime();
+    DDD reached = fixpoint(swap_events())(M0);
+    report(satnames[s], start, reached.nbStates());
+  }
+  GHom::setSaturationStrategy(GHom::ORDINARY);
+
+  return 0;
+}
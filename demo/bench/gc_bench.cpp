@@ -0,0 +1,116 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Micro benchmark of DDD garbage collection pauses.
+ *  A large set of nodes is kept alive, then each round creates short lived nodes and
+ *  collects them. This is run with generations disabled (every collection is major)
+ *  and with the default generational policy.
+ *  The collector uses nbthreads threads in parallel builds, even on machines with fewer cores.
+ *  usage : gc_bench [nbkept [nbtemp [rounds [nbthreads]]]] */
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#ifdef PARALLEL_DD
+#include <tbb/global_control.h>
+#endif
+
+#include "ddd/DDD.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+
+static int WIDTH = 16;
+static int NB_KEPT = 200000;
+static int NB_TEMP = 20000;
+static int ROUNDS = 16;
+// number of distinct leaves used as sons
+static const int NB_LEAVES = 64;
+
+static vector<DDD> leaves;
+
+// the node number k : arc i points to a pseudo random leaf, so that nodes (almost always) differ
+static GDDD build (int k) {
+  GDDD::Valuation val;
+  val.reserve(WIDTH);
+  for (int i = 0; i < WIDTH; ++i) {
+    val.push_back(GDDD::edge_t(i, leaves[ddd::int32_hash(k * WIDTH + i) % NB_LEAVES]));
+  }
+  return GDDD(0, val);
+}
+
+// returns the total pause of the rounds
+static double run (const char * name, int base) {
+  vector<DDD> kept;
+  kept.reserve(NB_KEPT);
+  for (int k = 0; k < NB_KEPT; ++k) {
+    kept.push_back(build(base + k));
+  }
+  double total = 0;
+  for (int r = 0; r < ROUNDS; ++r) {
+    for (int k = 0; k < NB_TEMP; ++k) {
+      build(base + NB_KEPT + r * NB_TEMP + k);
+    }
+    double start = process::getTotalTime();
+    MemoryManager::garbage();
+    total += process::getTotalTime() - start;
+  }
+  cout << name << "," << ROUNDS << "," << total << "," << total / ROUNDS << endl;
+  return total;
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    NB_KEPT = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    NB_TEMP = atoi(argv[2]);
+  }
+  if (argc >= 4) {
+    ROUNDS = atoi(argv[3]);
+  }
+  if (argc >= 5) {
+    MemoryManager::setGCThreads(atoi(argv[4]));
+  }
+#ifdef PARALLEL_DD
+  // TBB otherwise grants no more threads than there are cores
+  tbb::global_control parallelism (tbb::global_control::max_allowed_parallelism, 16);
+#endif
+
+  for (int i = 0; i < NB_LEAVES; ++i) {
+    leaves.push_back(DDD(1, i));
+  }
+
+  cout << "Policy ,collections ,Total pause(s) ,Mean pause(s)" << endl;
+
+  GDDD::setGCPolicy(0, 1);
+  run("full", 0);
+  // clean up, and reset collection statistics
+  MemoryManager::garbage();
+  DDD::pstats(true);
+
+  GDDD::setGCPolicy(2, 8);
+  run("generational", 1 << 24);
+  MemoryManager::garbage();
+  DDD::pstats(true);
+  return 0;
+}
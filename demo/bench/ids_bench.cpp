@@ -0,0 +1,90 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+
+/** Micro benchmark of the memory cost of the width of node identifiers.
+ *  Keeps nbnodes distinct nodes alive, each with width arcs to pseudo random leaves,
+ *  then computes the union of consecutive pairs to fill the computed table.
+ *  Build the library with and without --enable-large-ids to compare 32 and 64 bit ids.
+ *  usage : ids_bench [nbnodes [width]] */
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+
+static int NB_NODES = 1000000;
+static int WIDTH = 8;
+// number of distinct leaves used as sons
+static const int NB_LEAVES = 64;
+
+// the node number k : arc i points to a pseudo random leaf, so that nodes (almost always) differ
+static GDDD build (int k, const vector<DDD> & leaves) {
+  GDDD::Builder b(0);
+  for (int i = 0; i < WIDTH; ++i) {
+    b.add(i, leaves[ddd::int32_hash(k * WIDTH + i) % NB_LEAVES]);
+  }
+  return b.finalize();
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    NB_NODES = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    WIDTH = atoi(argv[2]);
+  }
+
+  cout << "sizeof(GDDD::id_t)=" << sizeof(GDDD::id_t) << " sizeof(GDDD::run_t)=" << sizeof(GDDD::run_t) << endl;
+  size_t mem0 = process::getResidentMemory();
+
+  vector<DDD> leaves;
+  for (int i = 0; i < NB_LEAVES; ++i) {
+    leaves.push_back(DDD(1, i));
+  }
+
+  double start = process::getTotalTime();
+  vector<DDD> nodes;
+  nodes.reserve(NB_NODES);
+  for (int k = 0; k < NB_NODES; ++k) {
+    nodes.push_back(build(k, leaves));
+  }
+  double build_time = process::getTotalTime() - start;
+  size_t mem_nodes = process::getResidentMemory();
+
+  start = process::getTotalTime();
+  for (int k = 0; k + 1 < NB_NODES; k += 2) {
+    nodes[k] + nodes[k + 1];
+  }
+  double union_time = process::getTotalTime() - start;
+  size_t mem_ops = process::getResidentMemory();
+
+  cout << "Phase ,Time(s) ,Mem(kb) ,bytes/node" << endl;
+  cout << "build," << build_time << "," << mem_nodes << "," << (mem_nodes - mem0) * 1024.0 / NB_NODES << endl;
+  cout << "union," << union_time << "," << mem_ops << "," << (mem_ops - mem0) * 1024.0 / NB_NODES << endl;
+  cout << "nodes : " << MemoryManager::nbDDD() << endl;
+
+  return 0;
+}
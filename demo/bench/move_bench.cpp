@@ -0,0 +1,108 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Micro benchmark of the reference counting saved by moving DDD handles.
+ *  Computes the reachable states of the towers of Hanoi level by level, as hanoi_v3 does,
+ *  keeping the sequence of reached sets. The same loop is run twice : once copying DDD
+ *  handles, as user code did before DDD had move operations, then moving them.
+ *  Each copy of a DDD costs a reference count update in the unicity table.
+ *  usage : move_bench [nbrings [rounds]] */
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/Hom.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+#include "../hanoi/hanoiHom.hh"
+
+static int ROUNDS = 20;
+
+// breadth first exploration, returns the number of levels
+static size_t explore (const vector<Hom> & events, const DDD & M0, bool moves) {
+  vector<DDD> levels;
+  DDD reached = M0;
+  while (true) {
+    DDD next = reached;
+    for (vector<Hom>::const_reverse_iterator it = events.rbegin(); it != events.rend(); ++it) {
+      next = (*it) (next);
+    }
+    if (next == reached) {
+      break;
+    }
+    if (moves) {
+      levels.push_back(std::move(reached));
+      reached = std::move(next);
+    } else {
+      levels.push_back(reached);
+      reached = next;
+    }
+  }
+  return levels.size();
+}
+
+static void run (const char * name, bool moves) {
+  // the initial state, all rings are on pole 0
+  DDD M0 = GDDD::one;
+  vector<Hom> events;
+  for (int i = 0; i < NB_RINGS; ++i) {
+    if (moves) {
+      M0 = DDD(i, 0, M0);
+      events.push_back(move_ring_id(i));
+    } else {
+      DDD next (i, 0, M0);
+      M0 = next;
+      Hom ev = move_ring_id(i);
+      events.push_back(ev);
+    }
+  }
+
+  size_t before = GDDD::refUpdates();
+  double start = process::getTotalTime();
+  size_t levels = 0;
+  for (int r = 0; r < ROUNDS; ++r) {
+    levels = explore(events, M0, moves);
+  }
+  double time = process::getTotalTime() - start;
+  size_t updates = GDDD::refUpdates() - before;
+  cout << name << "," << ROUNDS << "," << levels << "," << updates << "," << updates / ROUNDS << "," << time << endl;
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    NB_RINGS = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    ROUNDS = atoi(argv[2]);
+  }
+  initName();
+
+  cout << "Handles ,rounds ,levels ,Ref updates ,Ref updates per round ,Time(s)" << endl;
+
+  run("copy", false);
+  MemoryManager::garbage();
+  run("move", true);
+  return 0;
+}
@@ -0,0 +1,114 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Speedup of the parallel evaluation of saturation in a build with --enable-parallel.
+ *  Computes the reachable states of the towers of Hanoi with the saturation of hanoi_v2
+ *  (fixpoint of the union of the moves and the identity) and of hanoi_v5 (move_ring_sat_gen),
+ *  in task arenas of 1, 2, 4 and 8 threads. The images of the sons of a node by a fixpoint
+ *  are then computed in parallel, see _GHom::eval_skip.
+ *  Caches are emptied between runs, so that each run computes everything, and an untimed
+ *  run first warms up the allocators. More poles give wider nodes, hence more parallelism.
+ *  Arenas get their threads even on machines with fewer cores, so that the results of
+ *  concurrent runs are checked everywhere, but speedups are only meaningful with enough cores.
+ *  usage : parallel_bench [nbrings [nbpoles]] */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+using namespace std;
+
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+#include "ddd/DDD.h"
+#include "ddd/Hom.h"
+#include "ddd/MemoryManager.h"
+#include "../hanoi/hanoiHom.hh"
+
+static DDD M0;
+
+static DDD union_saturation () {
+  set<GHom> events;
+  for (int i = 0; i < NB_RINGS; ++i) {
+    events.insert(move_ring(i));
+  }
+  return fixpoint(GHom::add(events) + GHom::id) (M0);
+}
+
+static DDD sat_gen () {
+  return move_ring_sat_gen() (M0);
+}
+
+// returns the number of states, or -1 if a run disagrees with the sequential one
+static long double run (const char * name, DDD (*saturation) ()) {
+  long double states = 0;
+  double seq_time = 0;
+  saturation();
+  MemoryManager::garbage();
+  for (int nbthreads = 1; nbthreads <= 8; nbthreads *= 2) {
+    DDD ss;
+    tbb::task_arena arena (nbthreads);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    arena.execute([&] { ss = saturation(); });
+    double time = chrono::duration<double> (chrono::steady_clock::now() - start).count();
+    if (nbthreads == 1) {
+      seq_time = time;
+      states = ss.nbStates();
+    } else if (ss.nbStates() != states) {
+      states = -1;
+    }
+    cout << name << "," << nbthreads << "," << time << "," << (time > 0 ? seq_time / time : 0) << endl;
+    // the next run starts from empty caches
+    ss = GDDD::null;
+    MemoryManager::garbage();
+  }
+  return states;
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    NB_RINGS = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    NB_POLES = atoi(argv[2]);
+  }
+  initName();
+
+  // the initial state, all rings are on pole 0
+  M0 = GDDD::one;
+  for (int i = 0; i < NB_RINGS; ++i) {
+    M0 = DDD(i, 0, M0);
+  }
+
+  // TBB otherwise grants no more threads than there are cores
+  tbb::global_control parallelism (tbb::global_control::max_allowed_parallelism, 8);
+
+  cout << "Saturation ,Threads ,Time(s) ,speedup" << endl;
+  int errors = 0;
+  if (run("hanoi_v2", union_saturation) < 0) {
+    ++errors;
+  }
+  if (run("hanoi_v5", sat_gen) < 0) {
+    ++errors;
+  }
+  return errors;
+}
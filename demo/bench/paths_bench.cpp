@@ -0,0 +1,114 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Micro benchmark of the enumeration of the paths of DDD and SDD.
+ *  Enumerates with GDDD::path_iterator the states of a dense DDD (depth variables, each taking
+ *  domain values), of a sparse DDD of pseudo random paths, and with GSDD::path_iterator those
+ *  of a SDD whose arcs are labeled by DDD. The textual output of the sparse DDD is timed
+ *  for comparison.
+ *  usage : paths_bench [depth [domain]] */
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/DED.h"
+#include "ddd/SDD.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+
+static int DEPTH = 7;
+static int DOMAIN_SIZE = 10;
+static const int NB_PATHS = 200000;
+static const int SPARSE_DEPTH = 12;
+
+static void report (const char * phase, double time, size_t states, long sum) {
+  cout << phase << "," << states << "," << time << "," << (time > 0 ? states / time : 0) << "," << sum << endl;
+}
+
+/// counts the paths of [begin,end), and sums their last values so that the loop is not optimized away
+template <typename Iterator>
+static void enumerate (const char * phase, Iterator begin, Iterator end) {
+  double start = process::getTotalTime();
+  size_t states = 0;
+  long sum = 0;
+  for (Iterator it = begin ; it != end ; ++it) {
+    ++states;
+    sum += (*it)[it->size() - 1];
+  }
+  report(phase, process::getTotalTime() - start, states, sum);
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    DEPTH = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    DOMAIN_SIZE = atoi(argv[2]);
+  }
+
+  // each variable takes any value of the domain, a node per variable with a single run
+  DDD dense = GDDD::one;
+  for (int v = 0; v < DEPTH; ++v) {
+    dense = GDDD(v, 0, DOMAIN_SIZE - 1, dense);
+  }
+
+  // pseudo random paths, added a batch at a time
+  DDD sparse = GDDD::null;
+  vector<GDDD> batch;
+  for (int k = 0; k < NB_PATHS; ++k) {
+    GDDD path = GDDD::one;
+    for (int v = 0; v < SPARSE_DEPTH; ++v) {
+      path = GDDD(v, ddd::int32_hash(k * SPARSE_DEPTH + v) % 16, path);
+    }
+    batch.push_back(path);
+    if (batch.size() == 1000 || k == NB_PATHS - 1) {
+      batch.push_back(sparse);
+      sparse = DED::add(batch);
+      batch.clear();
+    }
+  }
+
+  // two levels, each labeled by the DDD of the values of half of the variables
+  DDD half = GDDD::one;
+  for (int v = 0; v < (DEPTH + 1) / 2; ++v) {
+    half = GDDD(v, 0, DOMAIN_SIZE - 1, half);
+  }
+  DDD other = GDDD::one;
+  for (int v = 0; v < DEPTH / 2; ++v) {
+    other = GDDD(v, 0, DOMAIN_SIZE - 1, other);
+  }
+  SDD hier = SDD(0, half, SDD(1, other));
+
+  cout << "Phase ,States ,Time(s) ,States/s ,Checksum" << endl;
+  enumerate("dense DDD", dense.paths_begin(), dense.paths_end());
+  enumerate("sparse DDD", sparse.paths_begin(), sparse.paths_end());
+  enumerate("SDD of DDD", hier.paths_begin(), hier.paths_end());
+
+  double start = process::getTotalTime();
+  ostringstream text;
+  text << sparse;
+  report("sparse DDD print", process::getTotalTime() - start, (size_t) sparse.nbStates(), text.str().size());
+  return 0;
+}
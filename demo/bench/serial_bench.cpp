@@ -0,0 +1,103 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+
+/** Micro benchmark of DDD serialization.
+ *  Builds a DDD of nbpaths pseudo random paths of depth variables, then saves and loads it
+ *  in the text format (saveDDD/loadDDD) and in the binary format (saveDDDBinary/loadDDDBinary).
+ *  usage : serial_bench [nbpaths [depth]] */
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/DED.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+
+static int NB_PATHS = 200000;
+static int DEPTH = 12;
+static const int DOMAIN_SIZE = 16;
+
+static void report (const char * phase, double time, size_t bytes) {
+  cout << phase << "," << time << "," << bytes << endl;
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    NB_PATHS = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    DEPTH = atoi(argv[2]);
+  }
+
+  // paths are added a batch at a time
+  DDD d = GDDD::null;
+  vector<GDDD> batch;
+  for (int k = 0; k < NB_PATHS; ++k) {
+    GDDD path = GDDD::one;
+    for (int v = 0; v < DEPTH; ++v) {
+      path = GDDD(v, ddd::int32_hash(k * DEPTH + v) % DOMAIN_SIZE, path);
+    }
+    batch.push_back(path);
+    if (batch.size() == 1000 || k == NB_PATHS - 1) {
+      batch.push_back(d);
+      d = DED::add(batch);
+      batch.clear();
+    }
+  }
+  vector<DDD> list(1, d);
+  cout << "Nodes : " << d.size() << " States : " << d.nbStates() << endl;
+  cout << "Format ,Time(s) ,Bytes" << endl;
+
+  double start = process::getTotalTime();
+  ostringstream text;
+  saveDDD(text, list);
+  report("save text", process::getTotalTime() - start, text.str().size());
+
+  start = process::getTotalTime();
+  istringstream text_in (text.str());
+  vector<DDD> loaded (1);
+  loadDDD(text_in, loaded);
+  report("load text", process::getTotalTime() - start, text.str().size());
+  if (loaded != list) {
+    cout << "text load differs" << endl;
+    return 1;
+  }
+
+  start = process::getTotalTime();
+  ostringstream bin;
+  saveDDDBinary(bin, list);
+  report("save binary", process::getTotalTime() - start, bin.str().size());
+
+  start = process::getTotalTime();
+  istringstream bin_in (bin.str());
+  loadDDDBinary(bin_in, loaded);
+  report("load binary", process::getTotalTime() - start, bin.str().size());
+  if (loaded != list) {
+    cout << "binary load differs" << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,124 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Micro benchmark of DDD snapshots.
+ *  Builds a DDD of nbpaths pseudo random paths of depth variables and saves it in the binary
+ *  format (saveDDDBinary) and as a snapshot file (saveDDDSnapshot). The nodes are then collected,
+ *  and the time to get the DDD back by loadDDDBinary is compared to the time of mapDDDSnapshot,
+ *  alone then followed by a lookup of a path and by a full traversal.
+ *  usage : snapshot_bench [nbpaths [depth [file]]] */
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/DED.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+
+static int NB_PATHS = 200000;
+static int DEPTH = 12;
+static const int DOMAIN_SIZE = 16;
+
+static GDDD path (int k) {
+  GDDD res = GDDD::one;
+  for (int v = 0; v < DEPTH; ++v) {
+    res = GDDD(v, ddd::int32_hash(k * DEPTH + v) % DOMAIN_SIZE, res);
+  }
+  return res;
+}
+
+static void report (const char * phase, double time) {
+  cout << phase << "," << time << endl;
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    NB_PATHS = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    DEPTH = atoi(argv[2]);
+  }
+  string file = argc >= 4 ? argv[3] : "snapshot_bench.snap";
+
+  long double states;
+  string bin;
+  {
+    // paths are added a batch at a time
+    DDD d = GDDD::null;
+    vector<GDDD> batch;
+    for (int k = 0; k < NB_PATHS; ++k) {
+      batch.push_back(path(k));
+      if (batch.size() == 1000 || k == NB_PATHS - 1) {
+        batch.push_back(d);
+        d = DED::add(batch);
+        batch.clear();
+      }
+    }
+    vector<DDD> list(1, d);
+    states = d.nbStates();
+    cout << "Nodes : " << d.size() << " States : " << states << endl;
+
+    ostringstream out;
+    saveDDDBinary(out, list);
+    bin = out.str();
+    ofstream snap (file.c_str(), ios::binary);
+    saveDDDSnapshot(snap, list);
+  }
+  // the table should be empty of the nodes of the snapshot before it is mapped
+  MemoryManager::garbage();
+  cout << "Phase ,Time(s)" << endl;
+
+  {
+    double start = process::getTotalTime();
+    istringstream in (bin);
+    vector<DDD> loaded;
+    loadDDDBinary(in, loaded);
+    report("load binary", process::getTotalTime() - start);
+  }
+  MemoryManager::garbage();
+
+  double start = process::getTotalTime();
+  vector<DDD> mapped;
+  mapDDDSnapshot(file, mapped);
+  report("map snapshot", process::getTotalTime() - start);
+
+  start = process::getTotalTime();
+  DDD member = mapped[0] * path(NB_PATHS / 2);
+  report("map + lookup", process::getTotalTime() - start);
+
+  start = process::getTotalTime();
+  long double mapped_states = mapped[0].nbStates();
+  report("map + traversal", process::getTotalTime() - start);
+
+  remove(file.c_str());
+  if (member == GDDD::null || mapped_states != states) {
+    cout << "snapshot differs" << endl;
+    return 1;
+  }
+  return 0;
+}
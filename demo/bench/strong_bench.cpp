@@ -0,0 +1,210 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Micro benchmark of user strong homomorphisms written with virtual functions (StrongHom)
+ *  against the same homomorphisms written with StaticStrongHom.
+ *  Creates many distinct instances of a selector, an assignment and an increment, as the
+ *  library's varEqState, setVarConst and incVar, then applies each of them to a random set
+ *  of states. Instances are distinct, so that no application is answered by the cache.
+ *  The versions are timed alternately, so that neither benefits from the order of runs.
+ *  The last column checks that both versions compute the same images.
+ *  usage : strong_bench [nbvars [nbstates]] */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <tuple>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/DED.h"
+#include "ddd/Hom.h"
+#include "ddd/StaticStrongHom.hh"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+
+static int NB_VARS = 10;
+static int NB_STATES = 2000;
+// each version is timed ROUNDS times, alternating with the other, the best time is kept
+static const int ROUNDS = 3;
+// values of the variables
+static const int DOMAIN = 16;
+
+/************************** virtual versions */
+
+class VirtualEq : public StrongHom {
+  int var, val;
+public:
+  VirtualEq (int vr, int vl) : var(vr), val(vl) {}
+  bool skip_variable (int vr) const { return vr != var; }
+  GDDD phiOne () const { return GDDD::one; }
+  GHom phi (int vr, int vl) const {
+    return vl == val ? GHom(vr, vl, GHom::id) : GHom(GDDD::null);
+  }
+  size_t hash () const { return 8097 * (ddd::int32_hash(var) ^ ddd::int32_hash(val)); }
+  bool operator== (const StrongHom & s) const {
+    const VirtualEq & o = (const VirtualEq &) s;
+    return var == o.var && val == o.val;
+  }
+  _GHom * clone () const { return new VirtualEq(*this); }
+};
+
+class VirtualSet : public StrongHom {
+  int var, val;
+public:
+  VirtualSet (int vr, int vl) : var(vr), val(vl) {}
+  bool skip_variable (int vr) const { return vr != var; }
+  GDDD phiOne () const { return GDDD::one; }
+  GHom phi (int vr, int) const { return GHom(vr, val, GHom::id); }
+  size_t hash () const { return 6619 * (ddd::int32_hash(var) ^ ddd::int32_hash(val)); }
+  bool operator== (const StrongHom & s) const {
+    const VirtualSet & o = (const VirtualSet &) s;
+    return var == o.var && val == o.val;
+  }
+  _GHom * clone () const { return new VirtualSet(*this); }
+};
+
+class VirtualInc : public StrongHom {
+  int var, val;
+public:
+  VirtualInc (int vr, int vl) : var(vr), val(vl) {}
+  bool skip_variable (int vr) const { return vr != var; }
+  GDDD phiOne () const { return GDDD::one; }
+  GHom phi (int vr, int vl) const { return GHom(vr, (vl + val) % DOMAIN); }
+  size_t hash () const { return 9049 * (ddd::int32_hash(var) ^ ddd::int32_hash(val)); }
+  bool operator== (const StrongHom & s) const {
+    const VirtualInc & o = (const VirtualInc &) s;
+    return var == o.var && val == o.val;
+  }
+  _GHom * clone () const { return new VirtualInc(*this); }
+};
+
+/************************** static versions */
+
+class StaticEq : public StaticStrongHom<StaticEq> {
+  int var, val;
+public:
+  StaticEq (int vr, int vl) : var(vr), val(vl) {}
+  bool skip_variable (int vr) const { return vr != var; }
+  GDDD phiOne () const { return GDDD::one; }
+  GHom phi (int vr, int vl) const {
+    return vl == val ? GHom(vr, vl, GHom::id) : GHom(GDDD::null);
+  }
+  std::tuple<int,int> key () const { return std::make_tuple(var, val); }
+};
+
+class StaticSet : public StaticStrongHom<StaticSet> {
+  int var, val;
+public:
+  StaticSet (int vr, int vl) : var(vr), val(vl) {}
+  bool skip_variable (int vr) const { return vr != var; }
+  GDDD phiOne () const { return GDDD::one; }
+  GHom phi (int vr, int) const { return GHom(vr, val, GHom::id); }
+  std::tuple<int,int> key () const { return std::make_tuple(var, val); }
+};
+
+class StaticInc : public StaticStrongHom<StaticInc> {
+  int var, val;
+public:
+  StaticInc (int vr, int vl) : var(vr), val(vl) {}
+  bool skip_variable (int vr) const { return vr != var; }
+  GDDD phiOne () const { return GDDD::one; }
+  GHom phi (int vr, int vl) const { return GHom(vr, (vl + val) % DOMAIN); }
+  std::tuple<int,int> key () const { return std::make_tuple(var, val); }
+};
+
+/************************** benchmark */
+
+// a random set of states over all the variables
+static DDD states () {
+  vector<GDDD> paths;
+  paths.reserve(NB_STATES);
+  for (int k = 0; k < NB_STATES; ++k) {
+    GDDD path = GDDD::one;
+    for (int v = 0; v < NB_VARS; ++v) {
+      path = GDDD(v, ddd::int32_hash(k * NB_VARS + v) % DOMAIN, path);
+    }
+    paths.push_back(path);
+  }
+  return DED::add(paths);
+}
+
+// applies the homs of every (var,val) to s, returns the union of the images
+template <typename H>
+static DDD apply_all (const DDD & s, double & build, double & eval) {
+  double start = process::getTotalTime();
+  vector<Hom> homs;
+  for (int v = 0; v < NB_VARS; ++v) {
+    for (int k = 0; k < DOMAIN; ++k) {
+      homs.push_back(GHom(H(v, k)));
+      // a second instance is found in the unicity table
+      homs.push_back(GHom(H(v, k)));
+    }
+  }
+  build = process::getTotalTime() - start;
+  start = process::getTotalTime();
+  vector<GDDD> images;
+  for (size_t i = 0; i < homs.size(); i += 2) {
+    images.push_back(homs[i] (s));
+  }
+  eval = process::getTotalTime() - start;
+  return DED::add(images);
+}
+
+template <typename V, typename S>
+static int compare (const char * name, const DDD & s) {
+  double vbuild = 1e9, veval = 1e9, sbuild = 1e9, seval = 1e9;
+  bool same = true;
+  for (int r = 0; r < ROUNDS; ++r) {
+    double build, eval;
+    DDD vres = apply_all<V>(s, build, eval);
+    vbuild = min(vbuild, build);
+    veval = min(veval, eval);
+    MemoryManager::garbage();
+    DDD sres = apply_all<S>(s, build, eval);
+    sbuild = min(sbuild, build);
+    seval = min(seval, eval);
+    MemoryManager::garbage();
+    same = same && vres == sres;
+  }
+  cout << name << "," << vbuild << "," << sbuild << "," << veval << "," << seval
+       << "," << (same ? "same" : "DIFFERENT") << endl;
+  return same ? 0 : 1;
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    NB_VARS = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    NB_STATES = atoi(argv[2]);
+  }
+
+  DDD s = states();
+  cout << "States : " << s.nbStates() << " Nodes : " << s.size() << endl;
+  cout << "Hom ,build virtual(s) ,build static(s) ,eval virtual(s) ,eval static(s) ,images" << endl;
+  int errors = 0;
+  errors += compare<VirtualEq, StaticEq>("var == k", s);
+  errors += compare<VirtualSet, StaticSet>("var := k", s);
+  errors += compare<VirtualInc, StaticInc>("var += k", s);
+  return errors;
+}
@@ -0,0 +1,92 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/** Micro benchmark of the DDD unique table.
+ *  Builds many distinct wide nodes (insertion = table misses), builds them again
+ *  (lookup = table hits), then runs a garbage collection that keeps all of them.
+ *  usage : unique_bench [width [nbnodes]] */
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/process.hpp"
+
+static int WIDTH = 256;
+static int NB_NODES = 20000;
+// number of distinct leaves used as sons
+static const int NB_LEAVES = 64;
+
+// the node number k : arc i points to a pseudo random leaf, so that nodes (almost always) differ
+static GDDD build (int k, const vector<DDD> & leaves) {
+  GDDD::Valuation val;
+  val.reserve(WIDTH);
+  for (int i = 0; i < WIDTH; ++i) {
+    val.push_back(GDDD::edge_t(i, leaves[ddd::int32_hash(k * WIDTH + i) % NB_LEAVES]));
+  }
+  return GDDD(0, val);
+}
+
+static void report (const char * phase, double time, size_t ops) {
+  cout << phase << "," << ops << "," << time << "," << (time > 0 ? ops / time : 0) << endl;
+}
+
+int main (int argc, char **argv) {
+  if (argc >= 2) {
+    WIDTH = atoi(argv[1]);
+  }
+  if (argc >= 3) {
+    NB_NODES = atoi(argv[2]);
+  }
+
+  vector<DDD> leaves;
+  for (int i = 0; i < NB_LEAVES; ++i) {
+    leaves.push_back(DDD(1, i));
+  }
+
+  cout << "Phase ,nodes ,Time(s) ,nodes/s" << endl;
+
+  vector<DDD> kept;
+  kept.reserve(NB_NODES);
+  double start = process::getTotalTime();
+  for (int k = 0; k < NB_NODES; ++k) {
+    kept.push_back(build(k, leaves));
+  }
+  report("insert", process::getTotalTime() - start, NB_NODES);
+  cout << "Mem(kb) after insert : " << process::getResidentMemory() << endl;
+
+  start = process::getTotalTime();
+  size_t hits = 0;
+  for (int k = 0; k < NB_NODES; ++k) {
+    if (build(k, leaves) == kept[k])
+      ++hits;
+  }
+  report("lookup", process::getTotalTime() - start, hits);
+
+  start = process::getTotalTime();
+  MemoryManager::garbage();
+  report("garbage", process::getTotalTime() - start, MemoryManager::nbDDD());
+
+  return (hits == (size_t) NB_NODES) ? 0 : 1;
+}
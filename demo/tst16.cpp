@@ -0,0 +1,123 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+/* Nodes at the limits of the width of values (configure --with-val-bits) :
+ * nodes with more than 2^16 runs, and arcs labeled by the bounds of DDD::val_t.
+ * Returns the number of failed checks. */
+#include <iostream>
+#include <limits>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/MemoryManager.h"
+
+typedef GDDD::val_t val_t;
+typedef GDDD::wide_val_t wide_val_t;
+
+static const wide_val_t vmin = numeric_limits<val_t>::min();
+static const wide_val_t vmax = numeric_limits<val_t>::max();
+
+static int errors = 0;
+
+static void check (bool cond, const char * what) {
+  cout << (cond ? "OK     " : "FAILED ") << what << endl;
+  if (! cond)
+    ++errors;
+}
+
+/// the number of runs of d, counted by iteration
+static size_t count_runs (const GDDD & d) {
+  size_t n = 0;
+  for (GDDD::const_run_iterator it = d.runs_begin(); it != d.runs_end(); ++it)
+    ++n;
+  return n;
+}
+
+int main () {
+  cout << "sizeof(DDD::val_t) : " << sizeof(val_t) << endl;
+  const DDD a (1, 0);
+  const DDD b (1, 1);
+
+  // values vmin, vmin+2, ... all lead to a : one run per value
+  const wide_val_t nsparse = min<wide_val_t> ((vmax - vmin + 1) / 2, 70000);
+  DDD sparse, shifted;
+  {
+    GDDD::Builder bs (0), bt (0);
+    for (wide_val_t i = 0; i < nsparse; ++i) {
+      bs.add(val_t (vmin + 2 * i), a);
+      bt.add(val_t (vmin + 2 * i + 1), a);
+    }
+    sparse = bs.finalize();
+    shifted = bt.finalize();
+  }
+  check(sparse.nbruns() == size_t (nsparse) && count_runs(sparse) == size_t (nsparse), "sparse node : one run per value");
+  check(sparse.nbStates() == nsparse, "sparse node : states");
+  // both interleave into a single run
+  DDD merged = sparse + shifted;
+  check(merged.nbruns() == 1 && merged.runs_begin()->lo == vmin
+        && merged.runs_begin()->hi == vmin + 2 * nsparse - 1, "sparse + shifted : a single run");
+  check((merged - shifted) == sparse, "sparse + shifted - shifted");
+  check((merged * sparse) == sparse, "sparse + shifted * sparse");
+
+  // consecutive values alternating between two sons : 2^16 runs or more, unless values are 8 bit
+  const wide_val_t ndense = min<wide_val_t> (vmax - vmin + 1, 70000);
+  DDD dense;
+  {
+    GDDD::Builder bd (0);
+    for (wide_val_t i = 0; i < ndense; ++i)
+      bd.add(val_t (vmin + i), i % 2 ? b : a);
+    dense = bd.finalize();
+  }
+  GDDD::Valuation valuation;
+  for (wide_val_t i = 0; i < ndense; ++i)
+    valuation.push_back(make_pair(val_t (vmin + i), GDDD (i % 2 ? b : a)));
+  const DDD dense2 = GDDD (0, valuation);
+  check(dense.nbruns() == size_t (ndense) && count_runs(dense) == size_t (ndense), "dense node : one run per value");
+  check(dense == dense2, "dense node : builder and valuation agree");
+  check(dense.nbStates() == ndense, "dense node : states");
+  const wide_val_t last = vmin + ndense - 1;
+  GDDD::const_run_iterator found = dense.find(val_t (last));
+  check(found != dense.runs_end() && found->son == (last % 2 == vmin % 2 ? a : b), "dense node : find the last value");
+  check((dense - dense2) == GDDD::null && (dense + dense2) == dense, "dense node : dense - dense, dense + dense");
+  MemoryManager::garbage();
+  check(dense.nbruns() == size_t (ndense) && dense == GDDD (0, valuation), "dense node : survives garbage");
+
+  // arcs labeled by the bounds of the values
+  const DDD low (0, val_t (vmin), a);
+  const DDD high (0, val_t (vmax), a);
+  const DDD all (0, val_t (vmin), val_t (vmax), a);
+  const DDD inner = vmax - vmin >= 2 ? DDD (0, val_t (vmin + 1), val_t (vmax - 1), a) : DDD (GDDD::null);
+  check(all.nbStates() == vmax - vmin + 1, "[min,max] : states");
+  check(all.nbruns() == 1 && all.runs_begin()->lo == vmin && all.runs_begin()->hi == vmax, "[min,max] : a single run");
+  check((low + inner + high) == all, "min + ]min,max[ + max");
+  check((all - low - high) == inner, "[min,max] - min - max");
+  check((all * high) == high && (all * low) == low, "[min,max] * max, [min,max] * min");
+  check(all.find(val_t (vmax)) != all.runs_end() && low.find(val_t (vmax)) == low.runs_end(), "find max");
+  GDDD::const_iterator it = high.begin();
+  check(it != high.end() && wide_val_t (it->first) == vmax, "arc iterator at max");
+  DDD split = all - DDD (0, 0, a);
+  check(split.nbruns() == 2 && split.nbStates() == vmax - vmin, "[min,max] - 0 : two runs");
+  check((split + DDD (0, 0, b)).nbruns() == 3, "[min,max] - 0 + 0 to another son : three runs");
+
+  cout << errors << " failed checks" << endl;
+  return errors;
+}
@@ -0,0 +1,182 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+
+/* Snapshots of DDD (saveDDDSnapshot, mapDDDSnapshot) : corrupted snapshot files are rejected
+ * with std::runtime_error before any of their ids is used, then an intact one is mapped.
+ * Returns the number of failed checks. */
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/MemoryManager.h"
+#include "ddd/hashfunc.hh"
+
+/// the layout of snapshot_header in DDD.cpp
+struct header {
+  char magic[8];
+  uint32_t version, soa_arcs, sizeof_val, sizeof_id, sizeof_node, padding;
+  uint64_t null_id, one_id, top_id;
+  uint64_t nb_nodes, nb_roots, nb_slots;
+  uint64_t roots_pos, offsets_pos, nodes_pos, slots_pos;
+  uint64_t file_size;
+};
+
+typedef GDDD::id_t node_id;
+
+static const char * file = "tst17.snap";
+static int errors = 0;
+
+static void check (bool cond, const char * what) {
+  cout << (cond ? "OK     " : "FAILED ") << what << endl;
+  if (! cond)
+    ++errors;
+}
+
+static void write_file (const string & bytes) {
+  ofstream out (file, ios::binary);
+  out.write(bytes.data(), bytes.size());
+}
+
+/// whether mapping bytes throws std::runtime_error
+static bool rejected (const string & bytes) {
+  write_file(bytes);
+  vector<DDD> list;
+  try {
+    mapDDDSnapshot(file, list);
+  } catch (std::runtime_error & e) {
+    return true;
+  }
+  return false;
+}
+
+template <typename T>
+static void poke (string & bytes, uint64_t pos, T value) {
+  memcpy(&bytes[pos], &value, sizeof(T));
+}
+
+template <typename T>
+static T peek (const string & bytes, uint64_t pos) {
+  T value;
+  memcpy(&value, &bytes[pos], sizeof(T));
+  return value;
+}
+
+/// a DDD of pseudo random paths
+static GDDD paths (int nb, int depth) {
+  GDDD res = GDDD::null;
+  for (int k = 0; k < nb; ++k) {
+    GDDD p = GDDD::one;
+    for (int v = 0; v < depth; ++v)
+      p = GDDD(v, ddd::int32_hash(k * depth + v) % 8, p);
+    res = res + p;
+  }
+  return res;
+}
+
+int main () {
+  string snap;
+  long double states;
+  {
+    vector<DDD> list (1, paths(200, 6));
+    list.push_back(GDDD::one);
+    states = list[0].nbStates();
+    ostringstream out;
+    saveDDDSnapshot(out, list);
+    snap = out.str();
+  }
+  // the table should be empty of the nodes of the snapshot before it is mapped
+  MemoryManager::garbage();
+
+  const header h = peek<header> (snap, 0);
+  const node_id frozen_bit = GDDD::frozen_bit;
+  check(h.nb_nodes > 1 && h.nb_roots == 2, "snapshot sections");
+
+  string bad = snap;
+  bad.resize(snap.size() - 1);
+  check(rejected(bad), "truncated file");
+
+  bad = snap;
+  poke<uint64_t> (bad, h.offsets_pos, h.slots_pos);
+  check(rejected(bad), "offset past the nodes");
+
+  bad = snap;
+  poke<uint64_t> (bad, h.offsets_pos, h.offsets_pos);
+  check(rejected(bad), "offset before the nodes");
+
+  bad = snap;
+  poke<uint64_t> (bad, h.offsets_pos, peek<uint64_t> (snap, h.offsets_pos) + 4);
+  check(rejected(bad), "misaligned offset");
+
+  bad = snap;
+  poke<uint64_t> (bad, h.offsets_pos + 8 * (h.nb_nodes - 1), h.slots_pos - 8);
+  check(rejected(bad), "node overflowing the nodes section");
+
+  // the first node saved gets the image of the root, whose sons are saved before the root
+  bad = snap;
+  poke<uint64_t> (bad, h.offsets_pos, peek<uint64_t> (snap, h.offsets_pos + 8 * (h.nb_nodes - 1)));
+  check(rejected(bad), "son saved after its node");
+
+  bad = snap;
+  poke<node_id> (bad, h.roots_pos, node_id (frozen_bit | h.nb_nodes));
+  check(rejected(bad), "root past the nodes");
+
+  bad = snap;
+  poke<node_id> (bad, h.roots_pos, node_id (12345));
+  check(rejected(bad), "root neither terminal nor node");
+
+  bad = snap;
+  for (uint64_t i = 0; i < h.nb_slots; ++i) {
+    if (peek<node_id> (snap, h.slots_pos + i * sizeof(node_id)) != 0) {
+      poke<node_id> (bad, h.slots_pos + i * sizeof(node_id), node_id (frozen_bit | h.nb_nodes));
+      break;
+    }
+  }
+  check(rejected(bad), "slot past the nodes");
+
+  bad = snap;
+  poke<uint32_t> (bad, 8, h.version + 1);
+  check(rejected(bad), "unsupported version");
+
+  // no corrupt file was mapped : the intact one still may be
+  write_file(snap);
+  vector<DDD> mapped;
+  try {
+    mapDDDSnapshot(file, mapped);
+    check(mapped.size() == 2 && mapped[0].nbStates() == states && mapped[1] == GDDD::one, "intact snapshot");
+    check(mapped[0] == paths(200, 6), "nodes built later are found in the snapshot");
+  } catch (std::runtime_error & e) {
+    check(false, e.what());
+  }
+  remove(file);
+
+  cout << errors << " failed checks" << endl;
+  return errors;
+}
@@ -0,0 +1,147 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+
+/* Save and load of DDD, in the text format (saveDDD, loadDDD) and the binary format
+ * (saveDDDBinary, loadDDDBinary), on the states of the towers of hanoi : the DDD loaded are the
+ * ones saved, also once the nodes were collected, and truncated binary streams are rejected.
+ * Returns the number of failed checks. */
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/MemoryManager.h"
+#include "hanoi/hanoiHom.hh"
+
+static int errors = 0;
+
+static void check (bool cond, const char * what) {
+  cout << (cond ? "OK     " : "FAILED ") << what << endl;
+  if (! cond)
+    ++errors;
+}
+
+/// the reachable states of the towers of hanoi, all rings on pole 0 initially
+static DDD hanoi_states () {
+  DDD M0 = GDDD::one;
+  for (int i = 0; i < NB_RINGS; i++)
+    M0 = DDD(i, 0, M0);
+  return fixpoint(move_ring_sat(NB_RINGS - 1)) (M0);
+}
+
+/// the states as saved, with terminals and a DDD sharing nodes with them
+static vector<DDD> saved_list () {
+  vector<DDD> list;
+  DDD ss = hanoi_states();
+  list.push_back(ss);
+  list.push_back(GDDD::one);
+  list.push_back(GDDD::null);
+  list.push_back(ss.runs_begin()->son);
+  list.push_back(ss);
+  return list;
+}
+
+static string save_text (const vector<DDD> & list) {
+  ostringstream out;
+  saveDDD(out, list);
+  return out.str();
+}
+
+static string save_binary (const vector<DDD> & list) {
+  ostringstream out;
+  saveDDDBinary(out, list);
+  return out.str();
+}
+
+/// whether loading bytes throws std::runtime_error
+static bool rejected (const string & bytes) {
+  istringstream in (bytes);
+  vector<DDD> list;
+  try {
+    loadDDDBinary(in, list);
+  } catch (std::runtime_error & e) {
+    return true;
+  }
+  return false;
+}
+
+int main () {
+  NB_RINGS = 6;
+  vector<DDD> list = saved_list();
+  check(list[0].nbStates() == 729, "hanoi states");
+
+  // round trips within the same table : the nodes loaded are the nodes saved
+  const string text = save_text(list);
+  const string bin = save_binary(list);
+  {
+    istringstream in (text);
+    // the text format needs the size of the list saved
+    vector<DDD> loaded (5);
+    loadDDD(in, loaded);
+    check(loaded == list, "text round trip");
+  }
+  {
+    istringstream in (bin);
+    vector<DDD> loaded;
+    loadDDDBinary(in, loaded);
+    check(loaded == list, "binary round trip");
+    check(in.peek() == istringstream::traits_type::eof(), "binary load stops at the end of the save");
+  }
+  check(bin.size() < text.size(), "binary smaller than text");
+
+  // round trips once the nodes saved were collected
+  const long double states = list[0].nbStates();
+  list.clear();
+  MemoryManager::garbage();
+  {
+    istringstream in (text);
+    vector<DDD> loaded (5);
+    loadDDD(in, loaded);
+    check(loaded.size() == 5 && loaded[0].nbStates() == states && loaded[4] == loaded[0]
+          && loaded[1] == GDDD::one && loaded[2] == GDDD::null, "text round trip after garbage");
+    check(save_text(loaded) == text, "text saved again identical");
+  }
+  MemoryManager::garbage();
+  {
+    istringstream in (bin);
+    vector<DDD> loaded;
+    loadDDDBinary(in, loaded);
+    check(loaded.size() == 5 && loaded[0].nbStates() == states && loaded[4] == loaded[0]
+          && loaded[1] == GDDD::one && loaded[2] == GDDD::null, "binary round trip after garbage");
+    check(save_binary(loaded) == bin, "binary saved again identical");
+    check(loaded == saved_list(), "binary load equals the states computed again");
+  }
+
+  // every strict prefix of a binary save is truncated
+  bool all_rejected = true;
+  for (size_t n = 0; n < bin.size(); ++n)
+    all_rejected = rejected(bin.substr(0, n)) && all_rejected;
+  check(all_rejected, "truncated binary streams throw std::runtime_error");
+  check(rejected(text), "text is not binary");
+
+  cout << errors << " failed checks" << endl;
+  return errors;
+}
@@ -0,0 +1,143 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+
+/* Binary save and load of SDD (saveSDDBinary, loadSDDBinary) on the states of the towers of
+ * hanoi : arcs labeled by DDD, by IntDataSet and by SDD, shared between the SDD saved. The SDD
+ * loaded are the ones saved, also once the nodes were collected, and truncated streams are
+ * rejected. Returns the number of failed checks. */
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/SDD.h"
+#include "ddd/IntDataSet.h"
+#include "ddd/MemoryManager.h"
+#include "hanoi/hanoiHom.hh"
+
+static int errors = 0;
+
+static void check (bool cond, const char * what) {
+  cout << (cond ? "OK     " : "FAILED ") << what << endl;
+  if (! cond)
+    ++errors;
+}
+
+/// the states of the hanoi towers, as a single SDD variable labeled by DDD
+static SDD hanoi_ddd_states () {
+  DDD M0 = GDDD::one;
+  for (int i = 0; i < NB_RINGS; i++)
+    M0 = DDD(i, 0, M0);
+  return saturateSDD_singleDepth() (SDD(0, M0));
+}
+
+/// the states of the hanoi towers, as SDD variables labeled by IntDataSet
+static SDD hanoi_int_states () {
+  SDD M0 = GSDD::one;
+  IntDataSet s (vector<int> (1, 0));
+  for (int i = 0; i < NB_RINGS; i++)
+    M0 = SDD(i, s, M0);
+  return saturateSDD_IntData() (M0);
+}
+
+/// the states as saved : both encodings, a hierarchical SDD of them, and terminals
+static vector<SDD> saved_list () {
+  vector<SDD> list;
+  SDD ddd_states = hanoi_ddd_states();
+  SDD int_states = hanoi_int_states();
+  list.push_back(ddd_states);
+  list.push_back(int_states);
+  list.push_back(SDD(1, int_states, SDD(0, ddd_states)));
+  list.push_back(GSDD::one);
+  list.push_back(GSDD::null);
+  list.push_back(int_states);
+  return list;
+}
+
+static string save_binary (const vector<SDD> & list) {
+  ostringstream out;
+  saveSDDBinary(out, list);
+  return out.str();
+}
+
+/// whether loading bytes throws std::runtime_error
+static bool rejected (const string & bytes) {
+  istringstream in (bytes);
+  vector<SDD> list;
+  try {
+    loadSDDBinary(in, list);
+  } catch (std::runtime_error & e) {
+    return true;
+  }
+  return false;
+}
+
+int main () {
+  NB_RINGS = 6;
+  vector<SDD> list = saved_list();
+  check(list[0].nbStates() == 729 && list[1].nbStates() == 729, "hanoi states");
+  check(list[2].nbStates() == 729 * 729, "hierarchical states");
+
+  // round trip within the same table : the nodes loaded are the nodes saved
+  const string bin = save_binary(list);
+  {
+    istringstream in (bin + "tail");
+    vector<SDD> loaded;
+    loadSDDBinary(in, loaded);
+    check(loaded == list, "binary round trip");
+    string rest;
+    in >> rest;
+    check(rest == "tail", "binary load stops at the end of the save");
+  }
+
+  // round trip once the nodes saved were collected
+  list.clear();
+  MemoryManager::garbage();
+  {
+    istringstream in (bin);
+    vector<SDD> loaded;
+    loadSDDBinary(in, loaded);
+    check(loaded.size() == 6 && loaded[0].nbStates() == 729 && loaded[1].nbStates() == 729
+          && loaded[2].nbStates() == 729 * 729 && loaded[5] == loaded[1]
+          && loaded[3] == GSDD::one && loaded[4] == GSDD::null, "binary round trip after garbage");
+    check(save_binary(loaded) == bin, "binary saved again identical");
+    check(loaded == saved_list(), "binary load equals the states computed again");
+  }
+
+  // every strict prefix of a binary save is truncated
+  bool all_rejected = true;
+  for (size_t n = 0; n < bin.size(); ++n)
+    all_rejected = rejected(bin.substr(0, n)) && all_rejected;
+  check(all_rejected, "truncated binary streams throw std::runtime_error");
+  {
+    ostringstream out;
+    saveDDDBinary(out, vector<DDD> (1, DDD(0, 1)));
+    check(rejected(out.str()), "a DDD save is not a SDD save");
+  }
+
+  cout << errors << " failed checks" << endl;
+  return errors;
+}
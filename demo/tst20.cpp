@@ -0,0 +1,195 @@
+/****************************************************************************/
+/*								            */
+/* This file is part of libDDD, a library for manipulation of DDD and SDD.  */
+/*     						                            */
+/*     Copyright (C) 2001-2008 Yann Thierry-Mieg, Jean-Michel Couvreur      */
+/*                             and Denis Poitrenaud                         */
+/*     						                            */
+/*     This program is free software; you can redistribute it and/or modify */
+/*     it under the terms of the GNU Lesser General Public License as       */
+/*     published by the Free Software Foundation; either version 3 of the   */
+/*     License, or (at your option) any later version.                      */
+/*     This program is distributed in the hope that it will be useful,      */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of       */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        */
+/*     GNU LEsserGeneral Public License for more details.                   */
+/*     						                            */
+/* You should have received a copy of the GNU Lesser General Public License */
+/*     along with this program; if not, write to the Free Software          */
+/*Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*     						                            */
+/****************************************************************************/
+
+
+/* Path iterators of DDD and SDD (paths_begin, paths_end, skip) : the paths enumerated are the
+ * states counted by nbStates, in the order of a walk over the arcs with const_iterator, and
+ * skip(depth) jumps to the next path that differs up to depth.
+ * Returns the number of failed checks. */
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <vector>
+using namespace std;
+
+#include "ddd/DDD.h"
+#include "ddd/SDD.h"
+#include "ddd/IntDataSet.h"
+#include "hanoi/hanoiHom.hh"
+
+typedef vector<int> path_t;
+
+static int errors = 0;
+
+static void check (bool cond, const char * what) {
+  cout << (cond ? "OK     " : "FAILED ") << what << endl;
+  if (! cond)
+    ++errors;
+}
+
+/// the paths of g to one, walking its arcs one value at a time
+static void walk (const GDDD & g, path_t & prefix, vector<path_t> & paths) {
+  if (g == GDDD::one) {
+    paths.push_back(prefix);
+    return;
+  }
+  if (g == GDDD::null || g == GDDD::top)
+    return;
+  for (GDDD::const_iterator it = g.begin(); it != g.end(); ++it) {
+    prefix.push_back(it->first);
+    walk(it->second, prefix, paths);
+    prefix.pop_back();
+  }
+}
+
+static vector<path_t> walk (const GDDD & g) {
+  vector<path_t> paths;
+  path_t prefix;
+  walk(g, prefix, paths);
+  return paths;
+}
+
+/// the paths given by a path iterator, which skips at depth unless depth is negative
+template <typename Iterator>
+static vector<path_t> enumerate (Iterator it, Iterator end, int depth = -1) {
+  vector<path_t> paths;
+  while (it != end) {
+    paths.push_back(path_t (it->begin(), it->end()));
+    if (depth >= 0 && it->size() > size_t (depth))
+      it.skip(depth);
+    else
+      ++it;
+  }
+  return paths;
+}
+
+static bool same_prefix (const path_t & a, const path_t & b, size_t depth) {
+  return a.size() > depth && b.size() > depth && equal(a.begin(), a.begin() + depth + 1, b.begin());
+}
+
+/// the paths expected from skipping at depth : the first of each run of paths sharing their
+/// values up to depth
+static vector<path_t> first_of_prefix (const vector<path_t> & paths, size_t depth) {
+  vector<path_t> res;
+  for (size_t i = 0; i < paths.size(); ++i)
+    if (res.empty() || ! same_prefix(res.back(), paths[i], depth))
+      res.push_back(paths[i]);
+  return res;
+}
+
+/// the prefixes of paths up to depth, or the whole paths if they are shorter
+static set<path_t> prefixes (const vector<path_t> & paths, size_t depth) {
+  set<path_t> res;
+  for (size_t i = 0; i < paths.size(); ++i)
+    res.insert(path_t (paths[i].begin(), paths[i].begin() + min(depth + 1, paths[i].size())));
+  return res;
+}
+
+/// whether a is b with some paths removed
+static bool subsequence (const vector<path_t> & a, const vector<path_t> & b) {
+  size_t j = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    while (j < b.size() && b[j] != a[i])
+      ++j;
+    if (j == b.size())
+      return false;
+    ++j;
+  }
+  return true;
+}
+
+static size_t max_length (const vector<path_t> & paths) {
+  size_t res = 0;
+  for (size_t i = 0; i < paths.size(); ++i)
+    res = max(res, paths[i].size());
+  return res;
+}
+
+static void check_ddd (const GDDD & g, const char * name) {
+  cout << name << endl;
+  const vector<path_t> paths = walk(g);
+  const vector<path_t> enumerated = enumerate(g.paths_begin(), g.paths_end());
+  check(enumerated.size() == g.nbStates(), "as many paths as states");
+  check(enumerated == paths, "the paths of the walk over the arcs");
+  bool skips = true;
+  for (size_t depth = 0; depth < max_length(paths); ++depth)
+    skips = enumerate(g.paths_begin(), g.paths_end(), depth) == first_of_prefix(paths, depth) && skips;
+  check(skips, "skip at each depth");
+}
+
+/// paths, the paths expected in the order of enumeration
+static void check_sdd (const GSDD & g, const vector<path_t> & paths, const char * name) {
+  cout << name << endl;
+  const vector<path_t> enumerated = enumerate(g.paths_begin(), g.paths_end());
+  check(enumerated.size() == g.nbStates(), "as many paths as states");
+  check(enumerated == paths, "the paths expected");
+  // paths through distinct arcs may share values, skip may give several paths with a prefix
+  bool skips = true;
+  for (size_t depth = 0; depth < max_length(paths); ++depth) {
+    const vector<path_t> skipped = enumerate(g.paths_begin(), g.paths_end(), depth);
+    skips = subsequence(skipped, paths) && prefixes(skipped, depth) == prefixes(paths, depth) && skips;
+  }
+  check(skips, "skip at each depth");
+}
+
+int main () {
+  NB_RINGS = 5;
+  DDD M0 = GDDD::one;
+  for (int i = 0; i < NB_RINGS; i++)
+    M0 = DDD(i, 0, M0);
+  const DDD hanoi = fixpoint(move_ring_sat(NB_RINGS - 1)) (M0);
+  check_ddd(hanoi, "hanoi DDD");
+
+  // paths of different lengths, wide runs and values up to the limits of val_t
+  const GDDD::val_t vmax = numeric_limits<GDDD::val_t>::max();
+  const DDD mixed = DDD(0, 0, 5, DDD(1, 1)) + DDD(0, 7, GDDD::one) + DDD(0, 9, DDD(1, 2, 4, DDD(2, 0, 1)))
+    + DDD(0, vmax - 2, vmax, DDD(1, vmax));
+  check_ddd(mixed, "DDD of paths of different lengths");
+  check_ddd(GDDD::one, "one");
+  check_ddd(GDDD::null, "null");
+  check(GDDD::top.paths_begin() == GDDD::top.paths_end(), "no path to top");
+
+  const vector<path_t> hanoi_paths = walk(hanoi);
+  check_sdd(SDD(0, hanoi), hanoi_paths, "hanoi SDD labeled by a DDD");
+
+  SDD I0 = GSDD::one;
+  IntDataSet s (vector<int> (1, 0));
+  for (int i = 0; i < NB_RINGS; i++)
+    I0 = SDD(i, s, I0);
+  const SDD hanoi_int = saturateSDD_IntData() (I0);
+  check_sdd(hanoi_int, hanoi_paths, "hanoi SDD labeled by IntDataSet");
+
+  // the values of the label of an arc, then those of its son
+  vector<path_t> product;
+  for (size_t i = 0; i < hanoi_paths.size(); ++i)
+    for (size_t j = 0; j < hanoi_paths.size(); ++j) {
+      product.push_back(hanoi_paths[i]);
+      product.back().insert(product.back().end(), hanoi_paths[j].begin(), hanoi_paths[j].end());
+    }
+  check_sdd(SDD(1, hanoi_int, SDD(0, hanoi)), product, "hierarchical SDD");
+  check_sdd(GSDD::one, vector<path_t> (1), "one");
+  check_sdd(GSDD::null, vector<path_t> (), "null");
+
+  cout << errors << " failed checks" << endl;
+  return errors;
+}